@@ -18,7 +18,7 @@
 //
 //   // Typical flow:
 //
-//   BM_Context *ctx = bm_create(1024);  // max commands per frame
+//   BM_Context *ctx = bm_create(1024);  // initial commands per frame
 //   bm_make_current(ctx);
 //   bm_set_logical_size(320.0f, 180.0f);
 //   bm_set_clear_color(bm_color_rgba(0.05f, 0.05f, 0.1f, 1.0f));
@@ -35,7 +35,7 @@
 //       bm_end_frame();
 //
 //       // Backend (e.g. SDL3) consumes the recorded commands:
-//       // bm_get_commands(ctx, &cmds, &count);
+//       // bm_get_commands(ctx, &view);
 //       // BM_SDL3_Render(...);
 //   }
 //
@@ -49,18 +49,95 @@
 extern "C" {
 #endif
 
+#include <stddef.h>
 #include <stdint.h>
 
+// ------------------------------------------------------------
+// Profiler hooks
+// ------------------------------------------------------------
+//
+// Define any of these before including bangerman.h (and the
+// backends) to see BangerMan's hot paths in a profiler (Tracy,
+// perfetto, extras/chrome-trace/bm_profile_chrome.h). Names are
+// string literals; each BEGIN is matched by an END with the same
+// name on the same thread. Compiled out by default.
+
+#ifndef BM_PROFILE_BEGIN
+#define BM_PROFILE_BEGIN(name) ((void)0)
+#endif
+#ifndef BM_PROFILE_END
+#define BM_PROFILE_END(name) ((void)0)
+#endif
+#ifndef BM_PROFILE_COUNTER
+#define BM_PROFILE_COUNTER(name, value) ((void)0)
+#endif
+
+// ------------------------------------------------------------
+// Build configuration
+// ------------------------------------------------------------
+//
+// Define any of these before every include of bangerman.h and the
+// backends to compile features out of both:
+//
+//   BM_CONFIG_NO_SHAPES          ellipses, polygons, polylines
+//                                (the tessellation helpers stay)
+//   BM_CONFIG_NO_TEXT            fonts and bm_text
+//   BM_CONFIG_NO_TILEMAPS
+//   BM_CONFIG_NO_PARTICLES
+//   BM_CONFIG_NO_PALETTE         indexed colors (bm_resolve_color
+//                                returns its argument)
+//   BM_CONFIG_NO_MERGE           bm_merge_rect_fills
+//   BM_CONFIG_NO_SUBMIT          bm_submit and its frame hooks
+//   BM_CONFIG_MINIMAL            all of the above: rects, lines and
+//                                sprites only
+//
+//   BM_CONFIG_NO_CONTEXT_CHECKS  calls that use the current context
+//                                assert one is set instead of
+//                                returning quietly
+//
+// Command type values and the BM_Command layout are the same in
+// every configuration, so captures and backends stay compatible.
+// extras/cpp/bangerman.hpp checks the command set at compile time.
+
+#ifdef BM_CONFIG_MINIMAL
+#ifndef BM_CONFIG_NO_SHAPES
+#define BM_CONFIG_NO_SHAPES
+#endif
+#ifndef BM_CONFIG_NO_TEXT
+#define BM_CONFIG_NO_TEXT
+#endif
+#ifndef BM_CONFIG_NO_TILEMAPS
+#define BM_CONFIG_NO_TILEMAPS
+#endif
+#ifndef BM_CONFIG_NO_PARTICLES
+#define BM_CONFIG_NO_PARTICLES
+#endif
+#ifndef BM_CONFIG_NO_PALETTE
+#define BM_CONFIG_NO_PALETTE
+#endif
+#ifndef BM_CONFIG_NO_MERGE
+#define BM_CONFIG_NO_MERGE
+#endif
+#ifndef BM_CONFIG_NO_SUBMIT
+#define BM_CONFIG_NO_SUBMIT
+#endif
+#endif // BM_CONFIG_MINIMAL
+
 // ------------------------------------------------------------
 // Public types
 // ------------------------------------------------------------
 
 typedef struct {
-    float r, g, b, a;
+    float    r, g, b, a;
+    uint32_t index;  // 0 = RGBA; n = palette entry n - 1, see bm_color_index
 } BM_Color;
 
 typedef int32_t BM_TextureId;
 
+typedef struct {
+    float x, y;
+} BM_Point;
+
 // Opaque context handle
 typedef struct BM_Context BM_Context;
 
@@ -68,8 +145,31 @@ typedef struct BM_Context BM_Context;
 // Public API
 // ------------------------------------------------------------
 
+// Allocator for a context's bulk storage (command blocks and the
+// frame arena); bookkeeping still uses malloc. Every size passed to
+// alloc is a multiple of `granularity` (a power of two, 0 = no
+// rounding): command blocks fill whole granules with as many
+// commands as fit, so a huge-page allocator can ask for whole pages
+// and waste none of them. free receives the size given to alloc. See extras/large-pages for mmap + hugetlb /
+// transparent huge pages with NUMA placement.
+typedef struct {
+    void*  (*alloc)(size_t size, void* user);  // NULL on failure
+    void   (*free)(void* ptr, size_t size, void* user);
+    void*  user;
+    size_t granularity;
+} BM_Allocator;
+
 // Context lifecycle
+//
+// Commands are stored in blocks of BM_COMMAND_BLOCK (or as many as
+// fill whole allocator granules, if more); a frame that outgrows them
+// appends blocks instead of moving what is recorded. A capacity
+// <= 0 picks a small default; bm_create_sized takes a size_t for
+// initial capacities beyond INT_MAX commands.
 BM_Context* bm_create(int command_capacity);
+BM_Context* bm_create_sized(size_t command_capacity);
+BM_Context* bm_create_with_allocator(size_t              command_capacity,
+                                     const BM_Allocator* allocator);  // copied; NULL = malloc
 void        bm_destroy(BM_Context* ctx);
 void        bm_make_current(BM_Context* ctx);
 
@@ -82,6 +182,12 @@ void     bm_set_clear_color(BM_Color color);
 BM_Color bm_get_clear_color(void);  // <- NEW: needed by SDL3 backend
 void     bm_set_draw_color(BM_Color color);
 
+// Same, for a given context rather than the current one (backends
+// rendering contexts from other threads).
+void     bm_context_get_logical_size(const BM_Context* ctx,
+                                     float* out_width, float* out_height);
+BM_Color bm_context_get_clear_color(const BM_Context* ctx);
+
 // Frame boundary
 void bm_begin_frame(void);
 void bm_end_frame(void);
@@ -96,33 +202,518 @@ void bm_sprite(BM_TextureId texture,
                float x, float y,
                float w, float h);
 
+#ifndef BM_CONFIG_NO_SHAPES
+// Shapes
+//
+// Ellipses record center + radii; polygons copy their vertices into
+// the frame arena (see below) and record the offset. Backends tessellate
+// (and cache tessellations) themselves. Polygons must be convex.
+void bm_circle_fill(float cx, float cy, float radius);
+void bm_circle_outline(float cx, float cy, float radius);
+void bm_ellipse_fill(float cx, float cy, float rx, float ry);
+void bm_ellipse_outline(float cx, float cy, float rx, float ry);
+void bm_triangle_fill(float x0, float y0,
+                      float x1, float y1,
+                      float x2, float y2);
+void bm_triangle_outline(float x0, float y0,
+                         float x1, float y1,
+                         float x2, float y2);
+void bm_polygon_fill(const BM_Point* points, int count);
+void bm_polygon_outline(const BM_Point* points, int count);
+
+// Open polyline through `count` points, `thickness` logical pixels
+// wide, stored in the frame arena. One command however many points;
+// backends draw it as a
+// single strip with miter joins (bevelled when too sharp).
+void bm_polyline(const BM_Point* points, int count, float thickness);
+#endif // BM_CONFIG_NO_SHAPES
+
 // Command buffer readback
 typedef enum {
     BM_CMD_RECT_FILL = 1,
     BM_CMD_RECT_OUTLINE,
     BM_CMD_LINE,
     BM_CMD_SPRITE,
+    BM_CMD_TEXT,
+    BM_CMD_TILEMAP,
+    BM_CMD_PARTICLES,
+    BM_CMD_ELLIPSE_FILL,
+    BM_CMD_ELLIPSE_OUTLINE,
+    BM_CMD_POLYGON_FILL,
+    BM_CMD_POLYGON_OUTLINE,
+    BM_CMD_POLYLINE,
+
+    BM_CMD_COUNT  // keep last: sizes per-type tables
 } BM_CommandType;
 
 typedef struct {
     BM_CommandType type;
     BM_Color       color;
-    float          x, y, w, h;
-    float          x2, y2;      // For lines
-    BM_TextureId   texture;     // For sprites
+    float          x, y, w, h;  // Ellipses: center + radii. Polygons: bounds
+    float          x2, y2;      // For lines. Polylines: x2 = thickness
+    BM_TextureId   texture;     // For sprites, text (font atlas)
+    const void*    object;      // Text (BM_Font), tilemap, particle emitter
+    uint32_t       first;       // Text: layout slot. Tilemap: first visible chunk.
+                                // Polygons, polylines: arena offset of the points
+    uint32_t       count;       // Text: glyph quads. Tilemap: last visible chunk.
+                                // Particles: live count when recorded.
+                                // Polygons, polylines: point count
 } BM_Command;
 
+// Minimum commands per context storage block (72 KiB).
+#ifndef BM_COMMAND_BLOCK
+#define BM_COMMAND_BLOCK 1024
+#endif
+
+// Commands [k * block_size, (k + 1) * block_size) live in blocks[k];
+// only the last block is partially used. Walk a view with
+// bm_command_iter / bm_command_next, or bm_command_at for random
+// access.
 typedef struct {
-    BM_Command* commands;
-    int         count;
+    BM_Command* const*   blocks;
+    size_t               block_size;  // commands per block
+    size_t               count;       // commands in the frame
+    const unsigned char* arena;       // this frame's command payloads
+    size_t               arena_size;
+    const uint32_t*      palette;     // 0xAARRGGBB, NULL if none set
+    int                  palette_size;
 } BM_CommandView;
 
 void bm_get_commands(const BM_Context* ctx,
                      BM_CommandView*   out_view);
 
+typedef struct {
+    BM_Command* const* blocks;  // next block
+    size_t             block_size;
+    size_t             left;    // commands in blocks not yet entered
+    const BM_Command*  cur;
+    const BM_Command*  end;     // end of the current block's run
+} BM_CommandIter;
+
+//   BM_CommandIter it = bm_command_iter(&view);
+//   for (const BM_Command* cmd; (cmd = bm_command_next(&it)); ) ...
+static inline BM_CommandIter bm_command_iter(const BM_CommandView* view) {
+    BM_CommandIter it = { view->blocks, view->block_size, view->count, NULL, NULL };
+    return it;
+}
+
+static inline const BM_Command* bm_command_next(BM_CommandIter* it) {
+    if (it->cur == it->end) {
+        if (it->left == 0) return NULL;
+        size_t n = it->left < it->block_size ? it->left : it->block_size;
+        it->cur   = *it->blocks++;
+        it->end   = it->cur + n;
+        it->left -= n;
+    }
+    return it->cur++;
+}
+
+static inline const BM_Command* bm_command_at(const BM_CommandView* view, size_t i) {
+    return &view->blocks[i / view->block_size][i % view->block_size];
+}
+
+// ------------------------------------------------------------
+// Frame arena
+// ------------------------------------------------------------
+//
+// Variable-length command payloads (polygon / polyline points) are
+// bump-allocated from a linear arena owned by the context and reset
+// by bm_begin_frame(). Commands reference payloads by byte offset,
+// so growing the arena never invalidates a recorded frame.
+//
+// The arena doubles until it fits the largest frame seen and then
+// stays put: steady-state recording never calls malloc or realloc.
+// Use the high-water mark (also in BM_FrameStats) to size it up
+// front with bm_reserve_frame_arena().
+
+#define BM_ARENA_ALIGN 16  // largest supported payload alignment
+
+void   bm_reserve_frame_arena(BM_Context* ctx, size_t bytes);
+size_t bm_frame_arena_high_water(const BM_Context* ctx);
+
+// For backends: `size` bytes at `offset` in the view's arena, NULL
+// if out of range (e.g. a damaged capture).
+const void* bm_command_payload(const BM_CommandView* view,
+                               uint32_t offset, size_t size);
+
+// For backends: vertices of a polygon or polyline command, NULL if
+// its range is not inside the view's arena.
+const BM_Point* bm_polygon_get_points(const BM_CommandView* view,
+                                      const BM_Command*     cmd);
+
+// For backends: extrudes a polyline into rows of edge points,
+// out[2 * i] left and out[2 * i + 1] right of the path. Joins whose
+// miter would exceed miter_limit half widths get two rows (bevel).
+// Repeated points are skipped. out must hold 4 * count points;
+// returns the row count (0 if the path has no length).
+int bm_polyline_tessellate(const BM_Point* points, int count,
+                           float half_width, float miter_limit,
+                           BM_Point* out);
+
+// ------------------------------------------------------------
+// Palette (indexed color)
+// ------------------------------------------------------------
+//
+// Any color argument may be a palette index (bm_color_index). The
+// palette in effect at bm_end_frame() is stored with the frame, so
+// changing it every frame is a cheap way to cycle colors. RGB
+// backends resolve indices with bm_resolve_color(); the CPU backend
+// can also rasterize indices directly (BM_CPURenderer.indexed).
+
+#define BM_PALETTE_SIZE 256
+
+#ifndef BM_CONFIG_NO_PALETTE
+// argb: `count` 0xAARRGGBB entries (copied); NULL or 0 removes it.
+void bm_set_palette(const uint32_t* argb, int count);
+
+// For backends: RGBA of a color, looking indices up in the view's
+// palette (opaque black if missing). Plain colors pass through.
+BM_Color bm_resolve_color(const BM_CommandView* view, BM_Color color);
+#else
+// No indices to look up: views carry no palette.
+static inline BM_Color bm_resolve_color(const BM_CommandView* view, BM_Color color) {
+    (void)view;
+    return color;
+}
+#endif
+
+// ------------------------------------------------------------
+// Command merging
+// ------------------------------------------------------------
+//
+// Optional pass over a finished frame that coalesces abutting
+// same-color BM_CMD_RECT_FILLs (sharing a whole edge) into larger
+// rects, so runs of unit tiles replay as a handful of fills. A rect
+// is only moved earlier past commands that do not overlap it, so the
+// frame renders the same; text, tilemaps and particles are never
+// crossed. Candidates are searched BM_MERGE_WINDOW commands back.
+
+#ifndef BM_CONFIG_NO_MERGE
+#ifndef BM_MERGE_WINDOW
+#define BM_MERGE_WINDOW 64
+#endif
+
+// Returns the number of commands removed (also added to
+// BM_FrameStats.merged_count). Call after bm_end_frame().
+size_t bm_merge_rect_fills(BM_Context* ctx);
+
+// Runs the pass inside bm_end_frame() on the current context,
+// before stats and capture see the frame. Off by default.
+void bm_set_rect_merging(int enable);
+#endif // BM_CONFIG_NO_MERGE
+
+// ------------------------------------------------------------
+// Concurrent submission
+// ------------------------------------------------------------
+//
+// Any thread may add self-contained commands (rects, lines, sprites,
+// ellipses: no arena payload, no host object) to a context's open
+// frame with bm_submit(), without a lock. A slot is reserved with one
+// atomic add in a pre-sized table of command blocks, written, then
+// published. bm_end_frame() seals the table, waits for reserved slots
+// to be published, sorts them by `key` and appends them after the
+// commands recorded on the owning thread. The frame is therefore the
+// same however producers interleaved; give each command its own key,
+// e.g. (system << 32) | sequence (equal keys fall back to comparing
+// the commands).
+//
+// Submissions outside bm_begin_frame .. bm_end_frame, or that find
+// the table full, return 0 and are dropped. A full table grows to the
+// frame's demand at the next bm_begin_frame; reserve up front to
+// never drop.
+
+#ifndef BM_CONFIG_NO_SUBMIT
+// Owning thread. Takes effect at once between frames, else at the
+// next bm_begin_frame.
+void bm_reserve_submit_slots(BM_Context* ctx, size_t count);
+
+// Any thread. `cmd` is copied; 1 if it will be in this frame.
+int  bm_submit(BM_Context* ctx, uint64_t key, const BM_Command* cmd);
+#endif // BM_CONFIG_NO_SUBMIT
+
+// ------------------------------------------------------------
+// Text (bitmap fonts)
+// ------------------------------------------------------------
+//
+// A font is a glyph table over one atlas texture. bm_text() records
+// a single BM_CMD_TEXT command; the laid-out glyph quads live in the
+// font's layout cache (keyed on the string hash), so a string that
+// is drawn every frame is only laid out once. Backends expand the
+// command with bm_text_get_quads().
+//
+// A layout stays alive while any live context's current or previous
+// frame may have used it, so contexts may share a font (recording
+// into them from one thread at a time).
+
+typedef struct BM_Font BM_Font;
+
+typedef struct {
+    uint32_t codepoint;
+    int      x, y, w, h;          // atlas rect, texels
+    int      x_offset, y_offset;  // from pen position to glyph top-left
+    int      advance;
+} BM_Glyph;
+
+typedef struct {
+    float x, y, w, h;             // relative to the text origin
+    float u0, v0, u1, v1;         // normalized atlas coordinates
+} BM_GlyphQuad;
+
+#ifndef BM_CONFIG_NO_TEXT
+// Fixed-width: atlas is a grid of cell_w x cell_h glyphs, row-major,
+// starting at first_codepoint.
+BM_Font* bm_font_create_fixed(BM_TextureId texture,
+                              int atlas_width, int atlas_height,
+                              int cell_width, int cell_height,
+                              uint32_t first_codepoint);
+
+// Proportional, from an explicit glyph table (copied).
+BM_Font* bm_font_create(BM_TextureId texture,
+                        int atlas_width, int atlas_height,
+                        int line_height,
+                        const BM_Glyph* glyphs, int glyph_count);
+
+// Proportional, from the text variant of an AngelCode BMFont .fnt
+// file already loaded in memory (first page only, no kerning).
+BM_Font* bm_font_create_bmfont(BM_TextureId texture, const char* fnt_text);
+
+void bm_font_destroy(BM_Font* font);
+
+void bm_text(BM_Font* font, float x, float y, const char* utf8);
+void bm_text_measure(BM_Font* font, const char* utf8,
+                     float* out_width, float* out_height);
+
+// For backends: glyph quads of a BM_CMD_TEXT command (NULL if none).
+const BM_GlyphQuad* bm_text_get_quads(const BM_Command* cmd, int* out_count);
+#endif // BM_CONFIG_NO_TEXT
+
+// ------------------------------------------------------------
+// Tilemaps
+// ------------------------------------------------------------
+//
+// A tilemap references a caller-owned grid of tile indices into a
+// tileset texture. bm_tilemap() records one BM_CMD_TILEMAP command
+// holding the range of visible chunks (culled in O(1) against the
+// logical canvas), so recording cost does not depend on map size.
+//
+// The map is split into BM_TILEMAP_CHUNK x BM_TILEMAP_CHUNK chunks,
+// each with a version that changes whenever its tiles are edited
+// through bm_tilemap_set()/bm_tilemap_invalidate(). Backends cache
+// chunk geometry and rebuild only chunks whose version changed.
+
+#define BM_TILEMAP_CHUNK 16
+#define BM_TILE_EMPTY    0xFFFFu
+
+typedef struct BM_Tilemap BM_Tilemap;
+typedef BM_GlyphQuad BM_TileQuad;  // same layout: rect + atlas coords
+
+#ifndef BM_CONFIG_NO_TILEMAPS
+
+// tiles[y * width + x] indexes the tileset row-major; the array
+// stays owned by the caller and must outlive the tilemap.
+BM_Tilemap* bm_tilemap_create(uint16_t* tiles, int width, int height,
+                              BM_TextureId tileset,
+                              int tileset_width, int tileset_height,
+                              int tile_width, int tile_height);
+void        bm_tilemap_destroy(BM_Tilemap* map);
+
+void     bm_tilemap_set(BM_Tilemap* map, int x, int y, uint16_t tile);
+uint16_t bm_tilemap_get(const BM_Tilemap* map, int x, int y);
+
+// Call after editing the tile array directly (tile coordinates).
+void bm_tilemap_invalidate(BM_Tilemap* map, int x, int y, int w, int h);
+
+// Draws the map with its origin at (-camera_x, -camera_y).
+void bm_tilemap(BM_Tilemap* map, float camera_x, float camera_y);
+
+// For backends.
+void     bm_tilemap_get_chunk_grid(const BM_Tilemap* map,
+                                   int* out_cols, int* out_rows);
+void     bm_tilemap_get_visible(const BM_Command* cmd,
+                                int* out_cx0, int* out_cy0,
+                                int* out_cx1, int* out_cy1);  // exclusive
+uint32_t bm_tilemap_chunk_version(const BM_Tilemap* map, int cx, int cy);
+
+// Writes the non-empty tiles of a chunk as quads in map pixels;
+// out must hold BM_TILEMAP_CHUNK * BM_TILEMAP_CHUNK quads.
+int bm_tilemap_build_chunk(const BM_Tilemap* map, int cx, int cy,
+                           BM_TileQuad* out);
+#endif // BM_CONFIG_NO_TILEMAPS
+
+// ------------------------------------------------------------
+// Particles
+// ------------------------------------------------------------
+//
+// An emitter owns its particles in structure-of-arrays form and
+// integrates them with SIMD (SSE2 when available). bm_particles()
+// records one BM_CMD_PARTICLES command that references the emitter
+// directly, so do not update an emitter between bm_end_frame() and
+// the backend render of that frame.
+//
+// Particles are square, `size` logical pixels wide, centered on
+// their position, with color faded from start to end over lifetime.
+
+typedef struct BM_ParticleEmitter BM_ParticleEmitter;
+
+typedef struct {
+    const float* x;        // centers
+    const float* y;
+    const float* t;        // normalized age, 0 = born, 1 = dead
+    int          count;
+    float        size;
+    BM_Color     color_start;
+    BM_Color     color_end;
+} BM_ParticleView;
+
+#ifndef BM_CONFIG_NO_PARTICLES
+BM_ParticleEmitter* bm_particles_create(int capacity);
+void                bm_particles_destroy(BM_ParticleEmitter* emitter);
+
+void bm_particles_set_gravity(BM_ParticleEmitter* emitter, float gx, float gy);
+void bm_particles_set_colors(BM_ParticleEmitter* emitter,
+                             BM_Color start, BM_Color end);
+void bm_particles_set_size(BM_ParticleEmitter* emitter, float size);
+
+// Returns 0 when the emitter is full.
+int  bm_particles_emit(BM_ParticleEmitter* emitter,
+                       float x, float y, float vx, float vy,
+                       float lifetime);
+void bm_particles_update(BM_ParticleEmitter* emitter, float dt);
+int  bm_particles_count(const BM_ParticleEmitter* emitter);
+
+void bm_particles(BM_ParticleEmitter* emitter);
+
+// For backends.
+void bm_particles_get_view(const BM_Command* cmd, BM_ParticleView* out_view);
+#endif // BM_CONFIG_NO_PARTICLES
+
+// ------------------------------------------------------------
+// Frame statistics (optional, #define BM_ENABLE_STATS)
+// ------------------------------------------------------------
+
+#ifdef BM_ENABLE_STATS
+
+// Filled by backends after replaying a frame.
+typedef struct {
+    int    draw_calls;      // primitives / geometry submissions issued
+    int    state_changes;   // draw color, texture, blend changes
+    double replay_seconds;
+} BM_BackendStats;
+
+// Filled at bm_end_frame().
+typedef struct {
+    size_t command_count;
+    size_t commands_by_type[BM_CMD_COUNT];  // indexed by BM_CommandType
+    size_t capacity;        // command storage after this frame
+    size_t high_water;      // largest command_count since bm_create
+    int    realloc_count;   // command block / arena growths this frame
+    size_t culled_count;    // commands culled at record time (off-screen
+                            // tilemaps)
+    size_t merged_count;    // commands removed by merging passes
+    size_t submitted_count; // bm_submit commands appended this frame
+    size_t submit_dropped;  // bm_submit calls that found the table full
+    size_t bytes_recorded;  // commands + arena payloads
+    size_t arena_used;      // frame arena bytes this frame
+    size_t arena_capacity;
+    size_t arena_high_water;
+    double record_seconds;  // bm_begin_frame -> bm_end_frame
+
+    // Last replay reported via bm_report_backend_stats(). Backends
+    // run after bm_end_frame, so inside the callback this is the
+    // previous frame's replay.
+    BM_BackendStats backend;
+} BM_FrameStats;
+
+typedef void (*BM_FrameStatsCallback)(const BM_FrameStats* stats,
+                                      void*                user);
+
+void bm_get_frame_stats(const BM_Context* ctx, BM_FrameStats* out_stats);
+
+// Called from bm_end_frame() on the current context; NULL disables.
+void bm_set_frame_stats_callback(BM_FrameStatsCallback callback,
+                                 void*                 user);
+
+void bm_report_backend_stats(BM_Context*            ctx,
+                             const BM_BackendStats* stats);
+
+// Monotonic clock used for the timings above (seconds).
+double bm_time_seconds(void);
+
+#endif // BM_ENABLE_STATS
+
+// ------------------------------------------------------------
+// Frame capture (optional, #define BM_ENABLE_CAPTURE)
+// ------------------------------------------------------------
+//
+// Records every frame of the current context to a binary file so
+// it can be replayed offline (benchmarks, bug reports).
+//
+// File layout (native endianness, checked on load):
+//
+//   BM_CaptureFileHeader
+//   { BM_CaptureFrameHeader, BM_Command[command_count],
+//     zero padding to BM_ARENA_ALIGN, arena bytes[arena_size] } * N
+//
+// Commands are stored exactly as recorded, so a loaded frame is a
+// zero-copy view into the mapped file. Captures are only portable
+// between builds with the same BM_Command layout (command_size).
+// Host object pointers (fonts, tilemaps, emitters) are meaningless
+// offline: the writer stores them as NULL, so those commands replay
+// as no-ops. The file is mapped read-only; frames that still hold a
+// pointer are rejected like a truncated tail.
+
+#ifdef BM_ENABLE_CAPTURE
+
+#define BM_CAPTURE_MAGIC       0x50434D42u  // "BMCP"
+#define BM_CAPTURE_FRAME_MAGIC 0x4D415246u  // "FRAM"
+#define BM_CAPTURE_VERSION     6u
+#define BM_CAPTURE_ENDIAN_TAG  0x01020304u
+
+typedef struct {
+    uint32_t magic;         // BM_CAPTURE_MAGIC
+    uint32_t version;       // BM_CAPTURE_VERSION
+    uint32_t command_size;  // sizeof(BM_Command) of the writer
+    uint32_t endian_tag;    // BM_CAPTURE_ENDIAN_TAG as written
+} BM_CaptureFileHeader;
+
+typedef struct {
+    uint32_t magic;          // BM_CAPTURE_FRAME_MAGIC
+    uint32_t command_count;
+    float    logical_width;
+    float    logical_height;
+    BM_Color clear_color;
+    uint32_t arena_size;     // multiple of BM_ARENA_ALIGN
+    uint32_t palette_size;   // 0 = no palette
+    uint32_t palette_offset; // arena offset of the palette
+} BM_CaptureFrameHeader;     // 48 bytes: commands start 16-byte aligned
+
+// Writer: frames are appended at every bm_end_frame() until
+// bm_capture_end(). Returns 1 on success, 0 on failure.
+int  bm_capture_begin(const char* path);
+void bm_capture_end(void);
+
+// Reader: maps a capture file read-only; views must not be written.
+typedef struct BM_CaptureFile BM_CaptureFile;
+
+typedef struct {
+    BM_CommandView view;            // points into the mapping
+    float          logical_width;
+    float          logical_height;
+    BM_Color       clear_color;
+} BM_CaptureFrame;
+
+BM_CaptureFile* bm_capture_open(const char* path);
+void            bm_capture_close(BM_CaptureFile* file);
+int             bm_capture_frame_count(const BM_CaptureFile* file);
+int             bm_capture_get_frame(const BM_CaptureFile* file,
+                                     int                   index,
+                                     BM_CaptureFrame*      out_frame);
+
+#endif // BM_ENABLE_CAPTURE
+
 // Color helpers
 static inline BM_Color bm_color_rgba(float r, float g, float b, float a) {
-    BM_Color c = { r, g, b, a };
+    BM_Color c = { r, g, b, a, 0 };
     return c;
 }
 
@@ -130,6 +721,19 @@ static inline BM_Color bm_color_rgb(float r, float g, float b) {
     return bm_color_rgba(r, g, b, 1.0f);
 }
 
+#ifndef BM_CONFIG_NO_PALETTE
+// Palette index, see bm_set_palette. RGBA is opaque black, what
+// bm_resolve_color returns when the palette lacks the entry.
+static inline BM_Color bm_color_index(uint8_t index) {
+    BM_Color c = { 0.0f, 0.0f, 0.0f, 1.0f, (uint32_t)index + 1u };
+    return c;
+}
+#endif
+
+static inline int bm_color_is_index(BM_Color c) {
+    return c.index != 0;
+}
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -146,59 +750,327 @@ static inline BM_Color bm_color_rgb(float r, float g, float b) {
 
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 #include <assert.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BM__SSE2 1
+#include <emmintrin.h>
+#endif
+
+// 64-bit atomics for bm_submit and tilemap versions. Read-modify-
+// writes are acq_rel, loads acquire, stores release.
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define BM__ATOMIC_ADD(p, v)   _InterlockedExchangeAdd64((volatile __int64*)(p), (v))
+#define BM__ATOMIC_XCHG(p, v)  _InterlockedExchange64((volatile __int64*)(p), (v))
+#define BM__ATOMIC_LOAD(p)     _InterlockedCompareExchange64((volatile __int64*)(p), 0, 0)
+#define BM__ATOMIC_STORE(p, v) ((void)_InterlockedExchange64((volatile __int64*)(p), (v)))
+#else
+#define BM__ATOMIC_ADD(p, v)   __atomic_fetch_add((p), (v), __ATOMIC_ACQ_REL)
+#define BM__ATOMIC_XCHG(p, v)  __atomic_exchange_n((p), (v), __ATOMIC_ACQ_REL)
+#define BM__ATOMIC_LOAD(p)     __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define BM__ATOMIC_STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#endif
+
+#ifdef BM__SSE2
+#define BM__SPIN_PAUSE() _mm_pause()
+#else
+#define BM__SPIN_PAUSE() ((void)0)
+#endif
+
+#if defined(BM_ENABLE_STATS) || defined(BM_ENABLE_CAPTURE)
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+#endif
+
+#ifdef BM_ENABLE_CAPTURE
+#include <stdio.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#endif
+
 // ------------------------------------------------------------
 // Internal types
 // ------------------------------------------------------------
 
+// Reservation counter value while no frame is open; far above any
+// capacity, so a late bm_submit fails its bounds check.
+#define BM__SUBMIT_SEALED ((int64_t)1 << 62)
+
+typedef struct {
+    uint64_t key;
+    int64_t  epoch;  // frame_index once the slot is written (atomic)
+} BM__SubmitSlot;
+
+typedef struct {
+    uint64_t          key;
+    const BM_Command* cmd;
+} BM__SubmitSort;
+
 struct BM_Context {
-    BM_Command* commands;
-    int         capacity;
-    int         count;
+    // block_size commands per block; blocks are kept across frames,
+    // so only a frame larger than any before allocates.
+    BM_Command** blocks;
+    size_t       block_count;  // allocated blocks
+    size_t       block_slots;  // capacity of `blocks`
+    size_t       block_size;
+    size_t       block_bytes;  // allocation size of one block
+    unsigned     block_shift;  // log2(block_size), 0 if not a power of two
+    BM_Allocator allocator;    // alloc == NULL: malloc
+    size_t       count;
+    uint32_t     frame_index;  // bumped by bm_begin_frame
+
+    // Frame arena, reset every frame like the commands
+    unsigned char* arena;
+    size_t         arena_capacity;
+    size_t         arena_used;
+    size_t         arena_high_water;
 
     float logical_width;
     float logical_height;
 
     BM_Color clear_color;
     BM_Color draw_color;
+
+#ifndef BM_CONFIG_NO_PALETTE
+    uint32_t palette[BM_PALETTE_SIZE];
+    int      palette_size;
+    uint32_t palette_offset;  // arena copy made by bm_end_frame
+#endif
+
+#ifndef BM_CONFIG_NO_MERGE
+    int merge_rects;  // bm_set_rect_merging
+#endif
+
+#ifndef BM_CONFIG_NO_SUBMIT
+    // bm_submit slot table: commands in blocks like the frame's own,
+    // resized only while sealed (between bm_end_frame and the next
+    // bm_begin_frame).
+    int64_t         submit_next;      // atomic reservation counter
+    int64_t         submit_capacity;  // atomic; read by producers
+    BM_Command**    submit_blocks;
+    BM__SubmitSlot* submit_slots;
+    BM__SubmitSort* submit_sort;
+    size_t          submit_demand;    // capacity wanted at next frame
+#endif
+
+#ifdef BM_ENABLE_STATS
+    BM_FrameStats         stats;          // last completed frame
+    size_t                high_water;
+    int                   realloc_count;  // reset in bm_begin_frame
+    size_t                merged_count;   // reset in bm_begin_frame
+    size_t                culled_count;   // reset in bm_begin_frame
+    size_t                submitted_count;
+    size_t                submit_dropped;
+    double                frame_start;
+    BM_FrameStatsCallback stats_callback;
+    void*                 stats_user;
+#endif
+
+#ifdef BM_ENABLE_CAPTURE
+    FILE* capture;  // non-NULL while bm_capture_begin() is active
+#endif
+
+#ifndef BM_CONFIG_NO_TEXT
+    // Font layout aging (bm__layout_horizon): frame clock of this
+    // frame, and of the oldest frame whose commands may still be read
+    // (atomic; INT64_MAX until the first bm_begin_frame).
+    int64_t     frame_clock;
+    int64_t     keep_clock;
+    BM_Context* next_context;  // g_bm_contexts list
+#endif
 };
 
 // Global current context pointer
 static BM_Context* g_bm_ctx = NULL;
 
+#ifndef BM_CONFIG_NO_TEXT
+// Every bm_begin_frame, in any context, takes the next frame clock
+// value (64-bit, never wraps). Fonts are shared between contexts, so
+// layouts are aged by this clock rather than a context's frame_index.
+static int64_t     g_bm_frame_clock  = 0;
+static int64_t     g_bm_context_lock = 0;
+static BM_Context* g_bm_contexts     = NULL;  // live contexts
+
+static void
+bm__contexts_lock(void)
+{
+    while (BM__ATOMIC_XCHG(&g_bm_context_lock, (int64_t)1)) {
+        BM__SPIN_PAUSE();
+    }
+}
+
+static void
+bm__contexts_unlock(void)
+{
+    BM__ATOMIC_STORE(&g_bm_context_lock, (int64_t)0);
+}
+
+// Oldest frame clock any live context may still read commands from;
+// layouts last used before it are referenced by no command.
+static int64_t
+bm__layout_horizon(void)
+{
+    int64_t horizon = INT64_MAX;
+    bm__contexts_lock();
+    for (BM_Context* c = g_bm_contexts; c; c = c->next_context) {
+        int64_t keep = BM__ATOMIC_LOAD(&c->keep_clock);
+        if (keep < horizon) horizon = keep;
+    }
+    bm__contexts_unlock();
+    return horizon;
+}
+#endif
+
+// Calls on the current context return early (with `v`) when none is
+// set, or only assert one is under BM_CONFIG_NO_CONTEXT_CHECKS.
+#ifndef BM_CONFIG_NO_CONTEXT_CHECKS
+#define BM__CHECK_CTX()     do { if (!g_bm_ctx) return; } while (0)
+#define BM__CHECK_CTX_OR(v) do { if (!g_bm_ctx) return (v); } while (0)
+#else
+#define BM__CHECK_CTX()     assert(g_bm_ctx)
+#define BM__CHECK_CTX_OR(v) assert(g_bm_ctx)
+#endif
+
 // ------------------------------------------------------------
 // Internal helpers
 // ------------------------------------------------------------
 
+// Power-of-two blocks (the default) index with a shift and mask;
+// blocks sized to allocator granules need a divide.
+#define BM__CMD_IN(ctx, blocks, i) \
+    ((ctx)->block_shift \
+        ? &(blocks)[(i) >> (ctx)->block_shift][(i) & ((ctx)->block_size - 1)] \
+        : &(blocks)[(i) / (ctx)->block_size][(i) % (ctx)->block_size])
+#define BM__CMD(ctx, i) BM__CMD_IN(ctx, (ctx)->blocks, i)
+
+static void*
+bm__bulk_alloc(BM_Context* ctx, size_t size)
+{
+    if (!ctx->allocator.alloc) return malloc(size);
+    return ctx->allocator.alloc(size, ctx->allocator.user);
+}
+
+static void
+bm__bulk_free(BM_Context* ctx, void* ptr, size_t size)
+{
+    if (!ptr) return;
+    if (!ctx->allocator.alloc) {
+        free(ptr);
+    } else {
+        ctx->allocator.free(ptr, size, ctx->allocator.user);
+    }
+}
+
+// Appends one block. Recorded commands never move; only the (small)
+// block pointer table is reallocated, doubling.
 static int
-bm__ensure_capacity(BM_Context* ctx, int needed_extra)
+bm__add_block(BM_Context* ctx)
 {
-    if (!ctx) return 0;
-    int required = ctx->count + needed_extra;
-    if (required <= ctx->capacity) return 1;
+    if (ctx->block_count == ctx->block_slots) {
+        size_t new_slots = ctx->block_slots ? ctx->block_slots * 2 : 16;
+        if (new_slots > (size_t)-1 / sizeof(BM_Command*)) return 0;
+        BM_Command** new_blocks =
+            (BM_Command**)realloc(ctx->blocks, new_slots * sizeof(BM_Command*));
+        if (!new_blocks) return 0;
+        ctx->blocks      = new_blocks;
+        ctx->block_slots = new_slots;
+    }
+
+    BM_PROFILE_BEGIN("bm_grow_commands");
+    BM_Command* block = (BM_Command*)bm__bulk_alloc(ctx, ctx->block_bytes);
+    BM_PROFILE_END("bm_grow_commands");
+    if (!block) return 0;
+
+    ctx->blocks[ctx->block_count++] = block;
+    return 1;
+}
+
+#ifndef BM_FRAME_ARENA_MIN
+#define BM_FRAME_ARENA_MIN 4096
+#endif
 
-    int new_cap = ctx->capacity ? ctx->capacity * 2 : 64;
-    if (new_cap < required) {
-        new_cap = required;
+static int
+bm__arena_grow(BM_Context* ctx, size_t required)
+{
+    size_t new_cap = ctx->arena_capacity ? ctx->arena_capacity : BM_FRAME_ARENA_MIN;
+    if (new_cap < ctx->allocator.granularity) {
+        new_cap = ctx->allocator.granularity;
+    }
+    while (new_cap < required) {
+        new_cap *= 2;
     }
 
-    BM_Command* new_buf =
-        (BM_Command*)realloc(ctx->commands, (size_t)new_cap * sizeof(BM_Command));
+    // malloc alignment covers BM_ARENA_ALIGN on every target we
+    // build for; offsets, not pointers, are what stay valid.
+    BM_PROFILE_BEGIN("bm_grow_arena");
+    unsigned char* new_buf;
+    if (!ctx->allocator.alloc) {
+        new_buf = (unsigned char*)realloc(ctx->arena, new_cap);
+    } else {
+        new_buf = (unsigned char*)bm__bulk_alloc(ctx, new_cap);
+        if (new_buf && ctx->arena) {
+            memcpy(new_buf, ctx->arena, ctx->arena_used);
+            bm__bulk_free(ctx, ctx->arena, ctx->arena_capacity);
+        }
+    }
+    BM_PROFILE_END("bm_grow_arena");
     if (!new_buf) return 0;
 
-    ctx->commands = new_buf;
-    ctx->capacity = new_cap;
+    ctx->arena          = new_buf;
+    ctx->arena_capacity = new_cap;
     return 1;
 }
 
+#if !defined(BM_CONFIG_NO_SHAPES) || !defined(BM_CONFIG_NO_PALETTE)
+// Bump-allocates `size` bytes aligned to `align` (a power of two up
+// to BM_ARENA_ALIGN). Returns NULL on failure; *out_offset receives
+// the offset commands should store.
+static void*
+bm__arena_alloc(BM_Context* ctx, size_t size, size_t align, uint32_t* out_offset)
+{
+    size_t offset = (ctx->arena_used + align - 1) & ~(align - 1);
+    size_t end    = offset + size;
+    if (end < offset || end > 0xFFFFFFFFu) return NULL;  // offsets are 32-bit
+
+    if (end > ctx->arena_capacity) {
+        if (!bm__arena_grow(ctx, end)) return NULL;
+#ifdef BM_ENABLE_STATS
+        ctx->realloc_count++;
+#endif
+    }
+    ctx->arena_used = end;
+    if (end > ctx->arena_high_water) {
+        ctx->arena_high_water = end;
+    }
+    *out_offset = (uint32_t)offset;
+    return ctx->arena + offset;
+}
+#endif
+
 static BM_Command*
 bm__push_command(BM_Context* ctx)
 {
-    if (!bm__ensure_capacity(ctx, 1)) {
-        return NULL;
+#ifndef BM_CONFIG_NO_CONTEXT_CHECKS
+    if (!ctx) return NULL;
+#endif
+    if (ctx->count == ctx->block_count * ctx->block_size) {
+        if (!bm__add_block(ctx)) return NULL;
+#ifdef BM_ENABLE_STATS
+        ctx->realloc_count++;
+#endif
     }
-    BM_Command* cmd = &ctx->commands[ctx->count++];
+    BM_Command* cmd = BM__CMD(ctx, ctx->count);
+    ctx->count++;
     memset(cmd, 0, sizeof(*cmd));
     return cmd;
 }
@@ -213,24 +1085,69 @@ bm_create(int command_capacity)
     if (command_capacity <= 0) {
         command_capacity = 64;
     }
+    return bm_create_with_allocator((size_t)command_capacity, NULL);
+}
+
+BM_Context*
+bm_create_sized(size_t command_capacity)
+{
+    return bm_create_with_allocator(command_capacity, NULL);
+}
+
+BM_Context*
+bm_create_with_allocator(size_t command_capacity, const BM_Allocator* allocator)
+{
+    if (command_capacity == 0) {
+        command_capacity = 64;
+    }
+    if (allocator && (!allocator->alloc || !allocator->free ||
+                      (allocator->granularity & (allocator->granularity - 1)))) {
+        return NULL;
+    }
 
     BM_Context* ctx = (BM_Context*)calloc(1, sizeof(BM_Context));
     if (!ctx) return NULL;
 
-    ctx->commands = (BM_Command*)calloc((size_t)command_capacity,
-                                        sizeof(BM_Command));
-    if (!ctx->commands) {
-        free(ctx);
-        return NULL;
+    // With a granularity, a block is the fewest whole granules that
+    // hold BM_COMMAND_BLOCK commands, filled with as many as fit.
+    ctx->block_bytes = BM_COMMAND_BLOCK * sizeof(BM_Command);
+    if (allocator) {
+        size_t g = allocator->granularity;
+        ctx->allocator = *allocator;
+        if (g) ctx->block_bytes = (ctx->block_bytes + g - 1) & ~(g - 1);
+    }
+    ctx->block_size  = ctx->block_bytes / sizeof(BM_Command);
+    ctx->block_shift = 0;
+    if ((ctx->block_size & (ctx->block_size - 1)) == 0) {
+        while (((size_t)1 << ctx->block_shift) < ctx->block_size) {
+            ctx->block_shift++;
+        }
+    }
+
+    size_t blocks = (command_capacity + ctx->block_size - 1) / ctx->block_size;
+    for (size_t i = 0; i < blocks; ++i) {
+        if (!bm__add_block(ctx)) {
+            bm_destroy(ctx);
+            return NULL;
+        }
     }
 
-    ctx->capacity       = command_capacity;
     ctx->count          = 0;
+#ifndef BM_CONFIG_NO_SUBMIT
+    ctx->submit_next    = BM__SUBMIT_SEALED;
+#endif
     ctx->logical_width  = 320.0f;
     ctx->logical_height = 180.0f;
     ctx->clear_color    = bm_color_rgba(0.0f, 0.0f, 0.0f, 1.0f);
     ctx->draw_color     = bm_color_rgba(1.0f, 1.0f, 1.0f, 1.0f);
 
+#ifndef BM_CONFIG_NO_TEXT
+    ctx->keep_clock = INT64_MAX;
+    bm__contexts_lock();
+    ctx->next_context = g_bm_contexts;
+    g_bm_contexts     = ctx;
+    bm__contexts_unlock();
+#endif
     return ctx;
 }
 
@@ -241,7 +1158,32 @@ bm_destroy(BM_Context* ctx)
     if (g_bm_ctx == ctx) {
         g_bm_ctx = NULL;
     }
-    free(ctx->commands);
+#ifndef BM_CONFIG_NO_TEXT
+    bm__contexts_lock();
+    for (BM_Context** p = &g_bm_contexts; *p; p = &(*p)->next_context) {
+        if (*p == ctx) {
+            *p = ctx->next_context;
+            break;
+        }
+    }
+    bm__contexts_unlock();
+#endif
+#ifdef BM_ENABLE_CAPTURE
+    if (ctx->capture) fclose(ctx->capture);
+#endif
+    for (size_t i = 0; i < ctx->block_count; ++i) {
+        bm__bulk_free(ctx, ctx->blocks[i], ctx->block_bytes);
+    }
+    free(ctx->blocks);
+#ifndef BM_CONFIG_NO_SUBMIT
+    for (size_t i = 0; i * ctx->block_size < (size_t)ctx->submit_capacity; ++i) {
+        bm__bulk_free(ctx, ctx->submit_blocks[i], ctx->block_bytes);
+    }
+    free(ctx->submit_blocks);
+    free(ctx->submit_slots);
+    free(ctx->submit_sort);
+#endif
+    bm__bulk_free(ctx, ctx->arena, ctx->arena_capacity);
     free(ctx);
 }
 
@@ -254,7 +1196,7 @@ bm_make_current(BM_Context* ctx)
 void
 bm_set_logical_size(float width, float height)
 {
-    if (!g_bm_ctx) return;
+    BM__CHECK_CTX();
     g_bm_ctx->logical_width  = width;
     g_bm_ctx->logical_height = height;
 }
@@ -262,7 +1204,7 @@ bm_set_logical_size(float width, float height)
 void
 bm_get_logical_size(float* out_width, float* out_height)
 {
-    if (!g_bm_ctx) return;
+    BM__CHECK_CTX();
     if (out_width)  *out_width  = g_bm_ctx->logical_width;
     if (out_height) *out_height = g_bm_ctx->logical_height;
 }
@@ -270,45 +1212,141 @@ bm_get_logical_size(float* out_width, float* out_height)
 void
 bm_set_clear_color(BM_Color color)
 {
-    if (!g_bm_ctx) return;
+    BM__CHECK_CTX();
     g_bm_ctx->clear_color = color;
 }
 
 BM_Color
 bm_get_clear_color(void)
 {
-    if (!g_bm_ctx) {
-        BM_Color c = {0.0f, 0.0f, 0.0f, 1.0f};
+    return bm_context_get_clear_color(g_bm_ctx);
+}
+
+void
+bm_context_get_logical_size(const BM_Context* ctx, float* out_width, float* out_height)
+{
+    if (!ctx) return;
+    if (out_width)  *out_width  = ctx->logical_width;
+    if (out_height) *out_height = ctx->logical_height;
+}
+
+BM_Color
+bm_context_get_clear_color(const BM_Context* ctx)
+{
+    if (!ctx) {
+        BM_Color c = {0.0f, 0.0f, 0.0f, 1.0f, 0};
         return c;
     }
-    return g_bm_ctx->clear_color;
+    return ctx->clear_color;
 }
 
 void
 bm_set_draw_color(BM_Color color)
 {
-    if (!g_bm_ctx) return;
+    BM__CHECK_CTX();
     g_bm_ctx->draw_color = color;
 }
 
+#ifndef BM_CONFIG_NO_SUBMIT
+static void bm__submit_open(BM_Context* ctx);
+#endif
+
 void
 bm_begin_frame(void)
 {
-    if (!g_bm_ctx) return;
-    g_bm_ctx->count = 0;
+    BM__CHECK_CTX();
+    g_bm_ctx->count      = 0;
+    g_bm_ctx->arena_used = 0;
+    g_bm_ctx->frame_index++;
+#ifndef BM_CONFIG_NO_TEXT
+    {
+        // The previous frame may still be read; anything older may not.
+        int64_t now = BM__ATOMIC_ADD(&g_bm_frame_clock, (int64_t)1) + 1;
+        BM__ATOMIC_STORE(&g_bm_ctx->keep_clock,
+                         g_bm_ctx->frame_clock ? g_bm_ctx->frame_clock : now);
+        g_bm_ctx->frame_clock = now;
+    }
+#endif
     // Clear is logical only; backends decide how to use clear_color.
+#ifdef BM_ENABLE_STATS
+    g_bm_ctx->realloc_count = 0;
+    g_bm_ctx->merged_count  = 0;
+    g_bm_ctx->culled_count  = 0;
+    g_bm_ctx->frame_start   = bm_time_seconds();
+#endif
+#ifndef BM_CONFIG_NO_SUBMIT
+    bm__submit_open(g_bm_ctx);
+#endif
+
+    // Zone spans the whole recording phase; closed in bm_end_frame.
+    BM_PROFILE_BEGIN("bm_record");
 }
 
+#ifndef BM_CONFIG_NO_MERGE
+static size_t bm__merge_rect_fills(BM_Context* ctx);
+#endif
+#ifndef BM_CONFIG_NO_SUBMIT
+static void bm__submit_close(BM_Context* ctx);
+#endif
+#ifdef BM_ENABLE_STATS
+static void bm__stats_end_frame(BM_Context* ctx);
+#endif
+#ifdef BM_ENABLE_CAPTURE
+static void bm__capture_write_frame(BM_Context* ctx);
+#endif
+
 void
 bm_end_frame(void)
 {
-    // Nothing special for now; backends will read commands afterwards.
+    // Backends read commands afterwards; only instrumentation hooks
+    // in here.
+    BM__CHECK_CTX();
+#ifndef BM_CONFIG_NO_SUBMIT
+    bm__submit_close(g_bm_ctx);
+#endif
+    BM_PROFILE_END("bm_record");
+    BM_PROFILE_COUNTER("bm_commands", g_bm_ctx->count);
+
+    BM_PROFILE_BEGIN("bm_end_frame");
+#ifndef BM_CONFIG_NO_PALETTE
+    // Snapshot the palette into the frame, so a capture replays the
+    // palette each frame was drawn with.
+    if (g_bm_ctx->palette_size > 0) {
+        size_t    bytes = (size_t)g_bm_ctx->palette_size * sizeof(uint32_t);
+        uint32_t* dst   = (uint32_t*)bm__arena_alloc(g_bm_ctx, bytes, sizeof(uint32_t),
+                                                     &g_bm_ctx->palette_offset);
+        if (dst) {
+            memcpy(dst, g_bm_ctx->palette, bytes);
+        } else {
+            g_bm_ctx->palette_offset = 0xFFFFFFFFu;
+        }
+    }
+#endif
+#ifndef BM_CONFIG_NO_MERGE
+    if (g_bm_ctx->merge_rects) {
+        size_t removed = bm__merge_rect_fills(g_bm_ctx);
+#ifdef BM_ENABLE_STATS
+        g_bm_ctx->merged_count += removed;
+#else
+        (void)removed;
+#endif
+    }
+#endif
+#ifdef BM_ENABLE_STATS
+    bm__stats_end_frame(g_bm_ctx);
+#endif
+#ifdef BM_ENABLE_CAPTURE
+    if (g_bm_ctx->capture) {
+        bm__capture_write_frame(g_bm_ctx);
+    }
+#endif
+    BM_PROFILE_END("bm_end_frame");
 }
 
 void
 bm_rect_fill(float x, float y, float w, float h)
 {
-    if (!g_bm_ctx) return;
+    BM__CHECK_CTX();
     BM_Command* cmd = bm__push_command(g_bm_ctx);
     if (!cmd) return;
 
@@ -323,7 +1361,7 @@ bm_rect_fill(float x, float y, float w, float h)
 void
 bm_rect_outline(float x, float y, float w, float h)
 {
-    if (!g_bm_ctx) return;
+    BM__CHECK_CTX();
     BM_Command* cmd = bm__push_command(g_bm_ctx);
     if (!cmd) return;
 
@@ -338,7 +1376,7 @@ bm_rect_outline(float x, float y, float w, float h)
 void
 bm_line(float x0, float y0, float x1, float y1)
 {
-    if (!g_bm_ctx) return;
+    BM__CHECK_CTX();
     BM_Command* cmd = bm__push_command(g_bm_ctx);
     if (!cmd) return;
 
@@ -355,7 +1393,7 @@ bm_sprite(BM_TextureId texture,
           float x, float y,
           float w, float h)
 {
-    if (!g_bm_ctx) return;
+    BM__CHECK_CTX();
     BM_Command* cmd = bm__push_command(g_bm_ctx);
     if (!cmd) return;
 
@@ -368,14 +1406,1869 @@ bm_sprite(BM_TextureId texture,
     cmd->h       = h;
 }
 
+#ifndef BM_CONFIG_NO_SHAPES
+static void
+bm__ellipse(BM_CommandType type, float cx, float cy, float rx, float ry)
+{
+    BM__CHECK_CTX();
+    BM_Command* cmd = bm__push_command(g_bm_ctx);
+    if (!cmd) return;
+
+    cmd->type  = type;
+    cmd->color = g_bm_ctx->draw_color;
+    cmd->x = cx;
+    cmd->y = cy;
+    cmd->w = rx;
+    cmd->h = ry;
+}
+
+void
+bm_circle_fill(float cx, float cy, float radius)
+{
+    bm__ellipse(BM_CMD_ELLIPSE_FILL, cx, cy, radius, radius);
+}
+
+void
+bm_circle_outline(float cx, float cy, float radius)
+{
+    bm__ellipse(BM_CMD_ELLIPSE_OUTLINE, cx, cy, radius, radius);
+}
+
+void
+bm_ellipse_fill(float cx, float cy, float rx, float ry)
+{
+    bm__ellipse(BM_CMD_ELLIPSE_FILL, cx, cy, rx, ry);
+}
+
+void
+bm_ellipse_outline(float cx, float cy, float rx, float ry)
+{
+    bm__ellipse(BM_CMD_ELLIPSE_OUTLINE, cx, cy, rx, ry);
+}
+
+static BM_Command*
+bm__polygon(BM_CommandType type, const BM_Point* points, int count)
+{
+    int min_count = type == BM_CMD_POLYLINE ? 2 : 3;
+    BM__CHECK_CTX_OR(NULL);
+    if (!points || count < min_count) return NULL;
+    size_t    mark   = g_bm_ctx->arena_used;
+    uint32_t  offset = 0;
+    BM_Point* dst    = (BM_Point*)bm__arena_alloc(g_bm_ctx,
+                                                  (size_t)count * sizeof(BM_Point),
+                                                  sizeof(float), &offset);
+    if (!dst) return NULL;
+    BM_Command* cmd = bm__push_command(g_bm_ctx);
+    if (!cmd) {
+        g_bm_ctx->arena_used = mark;
+        return NULL;
+    }
+
+    float min_x = points[0].x, max_x = points[0].x;
+    float min_y = points[0].y, max_y = points[0].y;
+    for (int i = 0; i < count; ++i) {
+        dst[i] = points[i];
+        if (points[i].x < min_x) min_x = points[i].x;
+        if (points[i].x > max_x) max_x = points[i].x;
+        if (points[i].y < min_y) min_y = points[i].y;
+        if (points[i].y > max_y) max_y = points[i].y;
+    }
+
+    cmd->type  = type;
+    cmd->color = g_bm_ctx->draw_color;
+    cmd->x     = min_x;
+    cmd->y     = min_y;
+    cmd->w     = max_x - min_x;
+    cmd->h     = max_y - min_y;
+    cmd->first = offset;
+    cmd->count = (uint32_t)count;
+    return cmd;
+}
+
+void
+bm_triangle_fill(float x0, float y0, float x1, float y1, float x2, float y2)
+{
+    BM_Point p[3] = { { x0, y0 }, { x1, y1 }, { x2, y2 } };
+    bm__polygon(BM_CMD_POLYGON_FILL, p, 3);
+}
+
+void
+bm_triangle_outline(float x0, float y0, float x1, float y1, float x2, float y2)
+{
+    BM_Point p[3] = { { x0, y0 }, { x1, y1 }, { x2, y2 } };
+    bm__polygon(BM_CMD_POLYGON_OUTLINE, p, 3);
+}
+
+void
+bm_polygon_fill(const BM_Point* points, int count)
+{
+    bm__polygon(BM_CMD_POLYGON_FILL, points, count);
+}
+
+void
+bm_polygon_outline(const BM_Point* points, int count)
+{
+    bm__polygon(BM_CMD_POLYGON_OUTLINE, points, count);
+}
+
+void
+bm_polyline(const BM_Point* points, int count, float thickness)
+{
+    if (thickness <= 0.0f) thickness = 1.0f;
+    BM_Command* cmd = bm__polygon(BM_CMD_POLYLINE, points, count);
+    if (!cmd) return;
+
+    // Bounds grow by half the stroke so culling stays conservative.
+    float half = thickness * 0.5f;
+    cmd->x  -= half;
+    cmd->y  -= half;
+    cmd->w  += thickness;
+    cmd->h  += thickness;
+    cmd->x2  = thickness;
+}
+#endif // BM_CONFIG_NO_SHAPES
+
 void
 bm_get_commands(const BM_Context* ctx,
                 BM_CommandView*   out_view)
 {
     if (!ctx || !out_view) return;
-    out_view->commands = ctx->commands;
-    out_view->count    = ctx->count;
+    out_view->blocks       = (BM_Command* const*)ctx->blocks;
+    out_view->block_size   = ctx->block_size;
+    out_view->count        = ctx->count;
+    out_view->arena        = ctx->arena;
+    out_view->arena_size   = ctx->arena_used;
+    out_view->palette      = NULL;
+    out_view->palette_size = 0;
+#ifndef BM_CONFIG_NO_PALETTE
+    if (ctx->palette_size > 0) {
+        out_view->palette = (const uint32_t*)bm_command_payload(
+            out_view, ctx->palette_offset,
+            (size_t)ctx->palette_size * sizeof(uint32_t));
+        if (out_view->palette) out_view->palette_size = ctx->palette_size;
+    }
+#endif
+}
+
+#ifndef BM_CONFIG_NO_PALETTE
+void
+bm_set_palette(const uint32_t* argb, int count)
+{
+    BM__CHECK_CTX();
+    if (!argb || count <= 0) {
+        g_bm_ctx->palette_size = 0;
+        return;
+    }
+    if (count > BM_PALETTE_SIZE) count = BM_PALETTE_SIZE;
+    memcpy(g_bm_ctx->palette, argb, (size_t)count * sizeof(uint32_t));
+    g_bm_ctx->palette_size   = count;
+    g_bm_ctx->palette_offset = 0xFFFFFFFFu;  // until the next bm_end_frame
+}
+
+BM_Color
+bm_resolve_color(const BM_CommandView* view, BM_Color color)
+{
+    if (!bm_color_is_index(color)) return color;
+
+    int      i = (int)color.index - 1;
+    uint32_t p = 0xFF000000u;
+    if (view && view->palette && i >= 0 && i < view->palette_size) {
+        p = view->palette[i];
+    }
+    const float k = 1.0f / 255.0f;
+    return bm_color_rgba((float)((p >> 16) & 0xFFu) * k,
+                         (float)((p >>  8) & 0xFFu) * k,
+                         (float)( p        & 0xFFu) * k,
+                         (float)( p >> 24)          * k);
+}
+#endif // BM_CONFIG_NO_PALETTE
+
+void
+bm_reserve_frame_arena(BM_Context* ctx, size_t bytes)
+{
+    if (!ctx || bytes <= ctx->arena_capacity) return;
+    bm__arena_grow(ctx, bytes);
+}
+
+size_t
+bm_frame_arena_high_water(const BM_Context* ctx)
+{
+    return ctx ? ctx->arena_high_water : 0;
+}
+
+const void*
+bm_command_payload(const BM_CommandView* view, uint32_t offset, size_t size)
+{
+    if (!view || !view->arena) return NULL;
+    if (offset > view->arena_size || size > view->arena_size - offset) return NULL;
+    return view->arena + offset;
+}
+
+static inline int
+bm__point_equal(BM_Point a, BM_Point b)
+{
+    return a.x == b.x && a.y == b.y;
+}
+
+int
+bm_polyline_tessellate(const BM_Point* p, int count,
+                       float half_width, float miter_limit,
+                       BM_Point* out)
+{
+    if (!p || !out || count < 2) return 0;
+
+    int   rows = 0;
+    int   last = -1;            // previous kept point
+    float nx0 = 0.0f, ny0 = 0.0f;  // normal of the incoming segment
+
+    for (int i = 0; i < count; ++i) {
+        if (last >= 0 && bm__point_equal(p[i], p[last])) continue;
+
+        int j = i + 1;
+        while (j < count && bm__point_equal(p[j], p[i])) ++j;
+        int   has_next = j < count;
+        float nx1 = 0.0f, ny1 = 0.0f;
+        if (has_next) {
+            float dx  = p[j].x - p[i].x;
+            float dy  = p[j].y - p[i].y;
+            float inv = 1.0f / sqrtf(dx * dx + dy * dy);
+            nx1 = -dy * inv;
+            ny1 =  dx * inv;
+        }
+        if (last < 0 && !has_next) return 0;  // a single point
+
+        // Offsets to emit for this point: one (miter / cap) or two.
+        float ox[2], oy[2];
+        int   n = 1;
+        if (last < 0) {
+            ox[0] = nx1 * half_width;  oy[0] = ny1 * half_width;
+        } else if (!has_next) {
+            ox[0] = nx0 * half_width;  oy[0] = ny0 * half_width;
+        } else {
+            float mx   = nx0 + nx1;
+            float my   = ny0 + ny1;
+            float mlen = sqrtf(mx * mx + my * my);
+            float cos_half = mlen * 0.5f;  // cos of half the turn angle
+            if (cos_half * miter_limit < 1.0f) {
+                ox[0] = nx0 * half_width;  oy[0] = ny0 * half_width;
+                ox[1] = nx1 * half_width;  oy[1] = ny1 * half_width;
+                n = 2;
+            } else {
+                float k = half_width / (mlen * cos_half);
+                ox[0] = mx * k;  oy[0] = my * k;
+            }
+        }
+
+        for (int k = 0; k < n; ++k) {
+            out[rows * 2 + 0].x = p[i].x + ox[k];
+            out[rows * 2 + 0].y = p[i].y + oy[k];
+            out[rows * 2 + 1].x = p[i].x - ox[k];
+            out[rows * 2 + 1].y = p[i].y - oy[k];
+            ++rows;
+        }
+        nx0  = nx1;
+        ny0  = ny1;
+        last = i;
+    }
+    return rows;
+}
+
+const BM_Point*
+bm_polygon_get_points(const BM_CommandView* view, const BM_Command* cmd)
+{
+    uint32_t min_count = cmd && cmd->type == BM_CMD_POLYLINE ? 2u : 3u;
+    if (!cmd || cmd->count < min_count || (cmd->first & (sizeof(float) - 1))) return NULL;
+    return (const BM_Point*)bm_command_payload(view, cmd->first,
+                                               (size_t)cmd->count * sizeof(BM_Point));
+}
+
+// ------------------------------------------------------------
+// Text (bitmap fonts)
+// ------------------------------------------------------------
+
+#ifndef BM_CONFIG_NO_TEXT
+#ifndef BM_FONT_LAYOUT_CACHE_MIN
+#define BM_FONT_LAYOUT_CACHE_MIN 64
+#endif
+
+typedef struct {
+    uint64_t      hash;        // 0 = free slot
+    uint32_t      length;
+    int64_t       last_clock;  // newest frame clock that used it
+    BM_GlyphQuad* quads;       // owns text too (one allocation)
+    const char*   text;        // copy of the string, compared on hit
+    int           quad_count;
+    float         width;
+    float         height;
+} BM__TextLayout;
+
+struct BM_Font {
+    BM_TextureId texture;
+    float        inv_atlas_w;
+    float        inv_atlas_h;
+    int          line_height;
+
+    BM_Glyph*    glyphs;       // sorted by codepoint
+    int          glyph_count;
+    int          ascii[128];   // glyph index or -1
+
+    // Layout cache: stable slots + open-addressed index (slot + 1)
+    BM__TextLayout* layouts;
+    int             layout_capacity;
+    int             layout_count;
+    int*            free_slots;
+    int             free_count;
+    int*            index;
+    int             index_mask;
+};
+
+static int
+bm__glyph_compare(const void* a, const void* b)
+{
+    uint32_t x = ((const BM_Glyph*)a)->codepoint;
+    uint32_t y = ((const BM_Glyph*)b)->codepoint;
+    return (x > y) - (x < y);
+}
+
+static const BM_Glyph*
+bm__font_find_glyph(const BM_Font* font, uint32_t cp)
+{
+    if (cp < 128) {
+        int i = font->ascii[cp];
+        return i >= 0 ? &font->glyphs[i] : NULL;
+    }
+    int lo = 0, hi = font->glyph_count - 1;
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        uint32_t c = font->glyphs[mid].codepoint;
+        if (c == cp) return &font->glyphs[mid];
+        if (c < cp) lo = mid + 1;
+        else        hi = mid - 1;
+    }
+    return NULL;
+}
+
+// Decodes one UTF-8 sequence; invalid bytes become U+FFFD.
+static uint32_t
+bm__utf8_next(const unsigned char** p)
+{
+    const unsigned char* s = *p;
+    uint32_t cp;
+    int      extra;
+
+    if      (s[0] < 0x80)           { cp = s[0];        extra = 0; }
+    else if ((s[0] & 0xE0) == 0xC0) { cp = s[0] & 0x1F; extra = 1; }
+    else if ((s[0] & 0xF0) == 0xE0) { cp = s[0] & 0x0F; extra = 2; }
+    else if ((s[0] & 0xF8) == 0xF0) { cp = s[0] & 0x07; extra = 3; }
+    else { *p = s + 1; return 0xFFFDu; }
+
+    for (int i = 1; i <= extra; ++i) {
+        if ((s[i] & 0xC0) != 0x80) { *p = s + i; return 0xFFFDu; }
+        cp = (cp << 6) | (s[i] & 0x3F);
+    }
+    *p = s + 1 + extra;
+    return cp;
+}
+
+static uint64_t
+bm__hash_string(const char* s, uint32_t* out_length)
+{
+    // FNV-1a 64
+    uint64_t h = 0xCBF29CE484222325ull;
+    uint32_t n = 0;
+    for (; s[n]; ++n) {
+        h ^= (unsigned char)s[n];
+        h *= 0x100000001B3ull;
+    }
+    *out_length = n;
+    return h | 1;  // never 0 (free-slot marker)
+}
+
+static BM_Font*
+bm__font_finish(BM_Font* font, int line_height)
+{
+    font->line_height = line_height;
+    qsort(font->glyphs, (size_t)font->glyph_count, sizeof(BM_Glyph),
+          bm__glyph_compare);
+    for (int i = 0; i < 128; ++i) font->ascii[i] = -1;
+    for (int i = 0; i < font->glyph_count; ++i) {
+        if (font->glyphs[i].codepoint < 128) {
+            font->ascii[font->glyphs[i].codepoint] = i;
+        }
+    }
+    return font;
+}
+
+static BM_Font*
+bm__font_alloc(BM_TextureId texture, int atlas_w, int atlas_h, int glyph_count)
+{
+    if (atlas_w <= 0 || atlas_h <= 0 || glyph_count < 0) return NULL;
+
+    BM_Font* font = (BM_Font*)calloc(1, sizeof(BM_Font));
+    if (!font) return NULL;
+    font->glyphs = (BM_Glyph*)calloc((size_t)(glyph_count ? glyph_count : 1),
+                                     sizeof(BM_Glyph));
+    if (!font->glyphs) {
+        free(font);
+        return NULL;
+    }
+    font->texture     = texture;
+    font->inv_atlas_w = 1.0f / (float)atlas_w;
+    font->inv_atlas_h = 1.0f / (float)atlas_h;
+    font->glyph_count = glyph_count;
+    return font;
+}
+
+BM_Font*
+bm_font_create_fixed(BM_TextureId texture,
+                     int atlas_width, int atlas_height,
+                     int cell_width, int cell_height,
+                     uint32_t first_codepoint)
+{
+    if (cell_width <= 0 || cell_height <= 0) return NULL;
+    int cols = atlas_width  / cell_width;
+    int rows = atlas_height / cell_height;
+
+    BM_Font* font = bm__font_alloc(texture, atlas_width, atlas_height, cols * rows);
+    if (!font) return NULL;
+
+    for (int i = 0; i < cols * rows; ++i) {
+        BM_Glyph* g  = &font->glyphs[i];
+        g->codepoint = first_codepoint + (uint32_t)i;
+        g->x         = (i % cols) * cell_width;
+        g->y         = (i / cols) * cell_height;
+        g->w         = cell_width;
+        g->h         = cell_height;
+        g->advance   = cell_width;
+    }
+    return bm__font_finish(font, cell_height);
+}
+
+BM_Font*
+bm_font_create(BM_TextureId texture,
+               int atlas_width, int atlas_height,
+               int line_height,
+               const BM_Glyph* glyphs, int glyph_count)
+{
+    if (!glyphs && glyph_count > 0) return NULL;
+    BM_Font* font = bm__font_alloc(texture, atlas_width, atlas_height, glyph_count);
+    if (!font) return NULL;
+    if (glyph_count > 0) {
+        memcpy(font->glyphs, glyphs, (size_t)glyph_count * sizeof(BM_Glyph));
+    }
+    return bm__font_finish(font, line_height);
+}
+
+// Reads "key=<int>" from one .fnt line; returns 1 if found.
+static int
+bm__fnt_int(const char* line, const char* end, const char* key, int* out)
+{
+    size_t klen = strlen(key);
+    for (const char* p = line; p + klen < end; ++p) {
+        if ((p == line || p[-1] == ' ' || p[-1] == '\t') &&
+            strncmp(p, key, klen) == 0 && p[klen] == '=') {
+            *out = (int)strtol(p + klen + 1, NULL, 10);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+BM_Font*
+bm_font_create_bmfont(BM_TextureId texture, const char* fnt_text)
+{
+    if (!fnt_text) return NULL;
+
+    int line_height = 0, atlas_w = 0, atlas_h = 0, glyph_count = 0;
+    for (const char* line = fnt_text; *line; ) {
+        const char* end = strchr(line, '\n');
+        if (!end) end = line + strlen(line);
+        if (strncmp(line, "common ", 7) == 0) {
+            bm__fnt_int(line, end, "lineHeight", &line_height);
+            bm__fnt_int(line, end, "scaleW", &atlas_w);
+            bm__fnt_int(line, end, "scaleH", &atlas_h);
+        } else if (strncmp(line, "char ", 5) == 0) {
+            glyph_count++;
+        }
+        line = *end ? end + 1 : end;
+    }
+
+    BM_Font* font = bm__font_alloc(texture, atlas_w, atlas_h, glyph_count);
+    if (!font) return NULL;
+
+    int n = 0;
+    for (const char* line = fnt_text; *line && n < glyph_count; ) {
+        const char* end = strchr(line, '\n');
+        if (!end) end = line + strlen(line);
+        if (strncmp(line, "char ", 5) == 0) {
+            BM_Glyph* g = &font->glyphs[n++];
+            int id = 0;
+            bm__fnt_int(line, end, "id",       &id);
+            bm__fnt_int(line, end, "x",        &g->x);
+            bm__fnt_int(line, end, "y",        &g->y);
+            bm__fnt_int(line, end, "width",    &g->w);
+            bm__fnt_int(line, end, "height",   &g->h);
+            bm__fnt_int(line, end, "xoffset",  &g->x_offset);
+            bm__fnt_int(line, end, "yoffset",  &g->y_offset);
+            bm__fnt_int(line, end, "xadvance", &g->advance);
+            g->codepoint = (uint32_t)id;
+        }
+        line = *end ? end + 1 : end;
+    }
+    return bm__font_finish(font, line_height);
+}
+
+void
+bm_font_destroy(BM_Font* font)
+{
+    if (!font) return;
+    for (int i = 0; i < font->layout_capacity; ++i) {
+        free(font->layouts[i].quads);
+    }
+    free(font->layouts);
+    free(font->free_slots);
+    free(font->index);
+    free(font->glyphs);
+    free(font);
+}
+
+static void
+bm__font_rebuild_index(BM_Font* font)
+{
+    for (int i = 0; i <= font->index_mask; ++i) font->index[i] = 0;
+    for (int s = 0; s < font->layout_capacity; ++s) {
+        if (!font->layouts[s].hash) continue;
+        int i = (int)(font->layouts[s].hash & (uint64_t)font->index_mask);
+        while (font->index[i]) i = (i + 1) & font->index_mask;
+        font->index[i] = s + 1;
+    }
+}
+
+// Makes room for one more layout: drops layouts no live frame can
+// reference, grows if everything is live. Returns a free slot or -1.
+static int
+bm__font_alloc_slot(BM_Font* font)
+{
+    if (font->free_count > 0) {
+        return font->free_slots[--font->free_count];
+    }
+
+    int64_t horizon = bm__layout_horizon();
+    for (int s = 0; s < font->layout_capacity; ++s) {
+        BM__TextLayout* l = &font->layouts[s];
+        if (l->hash && l->last_clock < horizon) {
+            free(l->quads);
+            memset(l, 0, sizeof(*l));
+            font->free_slots[font->free_count++] = s;
+            font->layout_count--;
+        }
+    }
+
+    if (font->free_count == 0) {
+        int old_cap = font->layout_capacity;
+        int new_cap = old_cap ? old_cap * 2 : BM_FONT_LAYOUT_CACHE_MIN;
+
+        BM__TextLayout* layouts = (BM__TextLayout*)realloc(
+            font->layouts, (size_t)new_cap * sizeof(BM__TextLayout));
+        if (!layouts) return -1;
+        font->layouts = layouts;
+        memset(layouts + old_cap, 0,
+               (size_t)(new_cap - old_cap) * sizeof(BM__TextLayout));
+
+        int* free_slots = (int*)realloc(font->free_slots,
+                                        (size_t)new_cap * sizeof(int));
+        if (!free_slots) return -1;
+        font->free_slots = free_slots;
+
+        // Index stays at most half full.
+        int* index = (int*)realloc(font->index, (size_t)new_cap * 2 * sizeof(int));
+        if (!index) return -1;
+        font->index      = index;
+        font->index_mask = new_cap * 2 - 1;
+
+        for (int s = new_cap - 1; s >= old_cap; --s) {
+            font->free_slots[font->free_count++] = s;
+        }
+        font->layout_capacity = new_cap;
+    }
+
+    bm__font_rebuild_index(font);
+    return font->free_slots[--font->free_count];
+}
+
+// `clock` is the frame clock of the recording frame (0 if none).
+static int
+bm__font_layout(BM_Font* font, const char* utf8, int64_t clock)
+{
+    uint32_t length;
+    uint64_t hash = bm__hash_string(utf8, &length);
+
+    if (font->index) {
+        int i = (int)(hash & (uint64_t)font->index_mask);
+        while (font->index[i]) {
+            int s = font->index[i] - 1;
+            BM__TextLayout* l = &font->layouts[s];
+            if (l->hash == hash && l->length == length &&
+                memcmp(l->text, utf8, length) == 0) {
+                // Never moves back: a newer frame may still use it.
+                if (l->last_clock < clock) l->last_clock = clock;
+                return s;
+            }
+            i = (i + 1) & font->index_mask;
+        }
+    }
+
+    // Miss: lay out. Quad count <= byte count; the string is kept
+    // after the quads so hash collisions cannot alias a layout.
+    size_t quad_bytes = (size_t)length * sizeof(BM_GlyphQuad);
+    BM_GlyphQuad* quads = (BM_GlyphQuad*)malloc(quad_bytes + length + 1);
+    if (!quads) return -1;
+    char* text = (char*)quads + quad_bytes;
+    memcpy(text, utf8, (size_t)length + 1);
+
+    int   n     = 0;
+    float pen_x = 0.0f, pen_y = 0.0f, width = 0.0f;
+    const unsigned char* p = (const unsigned char*)utf8;
+    while (*p) {
+        uint32_t cp = bm__utf8_next(&p);
+        if (cp == '\n') {
+            pen_x  = 0.0f;
+            pen_y += (float)font->line_height;
+            continue;
+        }
+        const BM_Glyph* g = bm__font_find_glyph(font, cp);
+        if (!g) g = bm__font_find_glyph(font, '?');
+        if (!g) continue;
+
+        if (g->w > 0 && g->h > 0) {
+            BM_GlyphQuad* q = &quads[n++];
+            q->x  = pen_x + (float)g->x_offset;
+            q->y  = pen_y + (float)g->y_offset;
+            q->w  = (float)g->w;
+            q->h  = (float)g->h;
+            q->u0 = (float)g->x * font->inv_atlas_w;
+            q->v0 = (float)g->y * font->inv_atlas_h;
+            q->u1 = (float)(g->x + g->w) * font->inv_atlas_w;
+            q->v1 = (float)(g->y + g->h) * font->inv_atlas_h;
+        }
+        pen_x += (float)g->advance;
+        if (pen_x > width) width = pen_x;
+    }
+
+    int s = bm__font_alloc_slot(font);
+    if (s < 0) {
+        free(quads);
+        return -1;
+    }
+
+    BM__TextLayout* l = &font->layouts[s];
+    l->hash       = hash;
+    l->length     = length;
+    l->last_clock = clock;
+    l->quads      = quads;
+    l->text       = text;
+    l->quad_count = n;
+    l->width      = width;
+    l->height     = pen_y + (float)font->line_height;
+    font->layout_count++;
+
+    int i = (int)(hash & (uint64_t)font->index_mask);
+    while (font->index[i]) i = (i + 1) & font->index_mask;
+    font->index[i] = s + 1;
+    return s;
+}
+
+void
+bm_text(BM_Font* font, float x, float y, const char* utf8)
+{
+    BM__CHECK_CTX();
+    if (!font || !utf8) return;
+
+    int slot = bm__font_layout(font, utf8, g_bm_ctx->frame_clock);
+    if (slot < 0) return;
+    const BM__TextLayout* l = &font->layouts[slot];
+    if (l->quad_count == 0) return;
+
+    BM_Command* cmd = bm__push_command(g_bm_ctx);
+    if (!cmd) return;
+
+    cmd->type    = BM_CMD_TEXT;
+    cmd->color   = g_bm_ctx->draw_color;
+    cmd->texture = font->texture;
+    cmd->object  = font;
+    cmd->first   = (uint32_t)slot;
+    cmd->count   = (uint32_t)l->quad_count;
+    cmd->x       = x;
+    cmd->y       = y;
+    cmd->w       = l->width;
+    cmd->h       = l->height;
+}
+
+void
+bm_text_measure(BM_Font* font, const char* utf8,
+                float* out_width, float* out_height)
+{
+    if (!font || !utf8) return;
+    int64_t clock = g_bm_ctx ? g_bm_ctx->frame_clock : 0;
+    int slot = bm__font_layout(font, utf8, clock);
+    if (slot < 0) return;
+    if (out_width)  *out_width  = font->layouts[slot].width;
+    if (out_height) *out_height = font->layouts[slot].height;
+}
+
+const BM_GlyphQuad*
+bm_text_get_quads(const BM_Command* cmd, int* out_count)
+{
+    if (out_count) *out_count = 0;
+    if (!cmd || cmd->type != BM_CMD_TEXT || !cmd->object) return NULL;
+
+    const BM_Font* font = (const BM_Font*)cmd->object;
+    if (cmd->first >= (uint32_t)font->layout_capacity) return NULL;
+    const BM__TextLayout* l = &font->layouts[cmd->first];
+    if (out_count) *out_count = l->quad_count;
+    return l->quads;
 }
 
+#endif // BM_CONFIG_NO_TEXT
+
+// ------------------------------------------------------------
+// Tilemaps
+// ------------------------------------------------------------
+
+#ifndef BM_CONFIG_NO_TILEMAPS
+struct BM_Tilemap {
+    uint16_t*    tiles;
+    int          width;
+    int          height;
+
+    BM_TextureId tileset;
+    int          tileset_cols;
+    float        inv_tileset_w;
+    float        inv_tileset_h;
+    int          tile_w;
+    int          tile_h;
+
+    int          chunk_cols;
+    int          chunk_rows;
+    uint32_t*    chunk_versions;
+};
+
+// Versions are unique across all tilemaps, so a backend cache entry
+// can never match a different (or re-allocated) map by accident.
+// Maps may be edited on different threads, hence the atomic counter.
+static int64_t g_bm_tile_version = 0;
+
+static uint32_t
+bm__tile_version_next(void)
+{
+    uint32_t v;
+    do {
+        v = (uint32_t)(BM__ATOMIC_ADD(&g_bm_tile_version, (int64_t)1) + 1);
+    } while (v == 0);  // 0 = never built, in backend caches
+    return v;
+}
+
+BM_Tilemap*
+bm_tilemap_create(uint16_t* tiles, int width, int height,
+                  BM_TextureId tileset,
+                  int tileset_width, int tileset_height,
+                  int tile_width, int tile_height)
+{
+    if (!tiles || width <= 0 || height <= 0) return NULL;
+    if (tile_width <= 0 || tile_height <= 0) return NULL;
+    if (tileset_width < tile_width || tileset_height < tile_height) return NULL;
+
+    BM_Tilemap* map = (BM_Tilemap*)calloc(1, sizeof(BM_Tilemap));
+    if (!map) return NULL;
+
+    map->tiles         = tiles;
+    map->width         = width;
+    map->height        = height;
+    map->tileset       = tileset;
+    map->tileset_cols  = tileset_width / tile_width;
+    map->inv_tileset_w = 1.0f / (float)tileset_width;
+    map->inv_tileset_h = 1.0f / (float)tileset_height;
+    map->tile_w        = tile_width;
+    map->tile_h        = tile_height;
+    map->chunk_cols    = (width  + BM_TILEMAP_CHUNK - 1) / BM_TILEMAP_CHUNK;
+    map->chunk_rows    = (height + BM_TILEMAP_CHUNK - 1) / BM_TILEMAP_CHUNK;
+
+    size_t n = (size_t)map->chunk_cols * (size_t)map->chunk_rows;
+    map->chunk_versions = (uint32_t*)malloc(n * sizeof(uint32_t));
+    if (!map->chunk_versions) {
+        free(map);
+        return NULL;
+    }
+    uint32_t v = bm__tile_version_next();
+    for (size_t i = 0; i < n; ++i) map->chunk_versions[i] = v;
+    return map;
+}
+
+void
+bm_tilemap_destroy(BM_Tilemap* map)
+{
+    if (!map) return;
+    free(map->chunk_versions);
+    free(map);
+}
+
+void
+bm_tilemap_invalidate(BM_Tilemap* map, int x, int y, int w, int h)
+{
+    if (!map) return;
+    int cx0 = x < 0 ? 0 : x / BM_TILEMAP_CHUNK;
+    int cy0 = y < 0 ? 0 : y / BM_TILEMAP_CHUNK;
+    int cx1 = (x + w + BM_TILEMAP_CHUNK - 1) / BM_TILEMAP_CHUNK;
+    int cy1 = (y + h + BM_TILEMAP_CHUNK - 1) / BM_TILEMAP_CHUNK;
+    if (cx1 > map->chunk_cols) cx1 = map->chunk_cols;
+    if (cy1 > map->chunk_rows) cy1 = map->chunk_rows;
+
+    uint32_t v = bm__tile_version_next();
+    for (int cy = cy0; cy < cy1; ++cy) {
+        for (int cx = cx0; cx < cx1; ++cx) {
+            map->chunk_versions[cy * map->chunk_cols + cx] = v;
+        }
+    }
+}
+
+void
+bm_tilemap_set(BM_Tilemap* map, int x, int y, uint16_t tile)
+{
+    if (!map || x < 0 || y < 0 || x >= map->width || y >= map->height) return;
+    uint16_t* t = &map->tiles[(size_t)y * (size_t)map->width + (size_t)x];
+    if (*t == tile) return;
+    *t = tile;
+    bm_tilemap_invalidate(map, x, y, 1, 1);
+}
+
+uint16_t
+bm_tilemap_get(const BM_Tilemap* map, int x, int y)
+{
+    if (!map || x < 0 || y < 0 || x >= map->width || y >= map->height) {
+        return BM_TILE_EMPTY;
+    }
+    return map->tiles[(size_t)y * (size_t)map->width + (size_t)x];
+}
+
+static int
+bm__floor_div(float v, int d)
+{
+    int i = (int)v;
+    if ((float)i > v) --i;  // floor for negatives
+    return i >= 0 ? i / d : -((-i + d - 1) / d);
+}
+
+void
+bm_tilemap(BM_Tilemap* map, float camera_x, float camera_y)
+{
+    BM__CHECK_CTX();
+    if (!map) return;
+
+    // Cull whole chunks against the logical canvas: O(1).
+    int chunk_px_w = map->tile_w * BM_TILEMAP_CHUNK;
+    int chunk_px_h = map->tile_h * BM_TILEMAP_CHUNK;
+    int cx0 = bm__floor_div(camera_x, chunk_px_w);
+    int cy0 = bm__floor_div(camera_y, chunk_px_h);
+    int cx1 = bm__floor_div(camera_x + g_bm_ctx->logical_width,  chunk_px_w) + 1;
+    int cy1 = bm__floor_div(camera_y + g_bm_ctx->logical_height, chunk_px_h) + 1;
+    if (cx0 < 0) cx0 = 0;
+    if (cy0 < 0) cy0 = 0;
+    if (cx1 > map->chunk_cols) cx1 = map->chunk_cols;
+    if (cy1 > map->chunk_rows) cy1 = map->chunk_rows;
+    if (cx0 >= cx1 || cy0 >= cy1) {
+#ifdef BM_ENABLE_STATS
+        g_bm_ctx->culled_count++;
+#endif
+        return;
+    }
+
+    BM_Command* cmd = bm__push_command(g_bm_ctx);
+    if (!cmd) return;
+
+    cmd->type    = BM_CMD_TILEMAP;
+    cmd->color   = g_bm_ctx->draw_color;
+    cmd->texture = map->tileset;
+    cmd->object  = map;
+    cmd->x       = -camera_x;
+    cmd->y       = -camera_y;
+    cmd->w       = (float)(map->width  * map->tile_w);
+    cmd->h       = (float)(map->height * map->tile_h);
+    cmd->first   = (uint32_t)cx0 | ((uint32_t)cy0 << 16);
+    cmd->count   = (uint32_t)cx1 | ((uint32_t)cy1 << 16);
+}
+
+void
+bm_tilemap_get_chunk_grid(const BM_Tilemap* map, int* out_cols, int* out_rows)
+{
+    if (out_cols) *out_cols = map ? map->chunk_cols : 0;
+    if (out_rows) *out_rows = map ? map->chunk_rows : 0;
+}
+
+void
+bm_tilemap_get_visible(const BM_Command* cmd,
+                       int* out_cx0, int* out_cy0,
+                       int* out_cx1, int* out_cy1)
+{
+    uint32_t a = cmd ? cmd->first : 0;
+    uint32_t b = cmd ? cmd->count : 0;
+    if (out_cx0) *out_cx0 = (int)(a & 0xFFFFu);
+    if (out_cy0) *out_cy0 = (int)(a >> 16);
+    if (out_cx1) *out_cx1 = (int)(b & 0xFFFFu);
+    if (out_cy1) *out_cy1 = (int)(b >> 16);
+}
+
+uint32_t
+bm_tilemap_chunk_version(const BM_Tilemap* map, int cx, int cy)
+{
+    if (!map || cx < 0 || cy < 0 ||
+        cx >= map->chunk_cols || cy >= map->chunk_rows) return 0;
+    return map->chunk_versions[cy * map->chunk_cols + cx];
+}
+
+int
+bm_tilemap_build_chunk(const BM_Tilemap* map, int cx, int cy, BM_TileQuad* out)
+{
+    if (!map || !out) return 0;
+    int tx0 = cx * BM_TILEMAP_CHUNK;
+    int ty0 = cy * BM_TILEMAP_CHUNK;
+    int tx1 = tx0 + BM_TILEMAP_CHUNK < map->width  ? tx0 + BM_TILEMAP_CHUNK : map->width;
+    int ty1 = ty0 + BM_TILEMAP_CHUNK < map->height ? ty0 + BM_TILEMAP_CHUNK : map->height;
+
+    int n = 0;
+    for (int ty = ty0; ty < ty1; ++ty) {
+        const uint16_t* row = map->tiles + (size_t)ty * (size_t)map->width;
+        for (int tx = tx0; tx < tx1; ++tx) {
+            uint16_t t = row[tx];
+            if (t == BM_TILE_EMPTY) continue;
+            int sx = (t % map->tileset_cols) * map->tile_w;
+            int sy = (t / map->tileset_cols) * map->tile_h;
+
+            BM_TileQuad* q = &out[n++];
+            q->x  = (float)(tx * map->tile_w);
+            q->y  = (float)(ty * map->tile_h);
+            q->w  = (float)map->tile_w;
+            q->h  = (float)map->tile_h;
+            q->u0 = (float)sx * map->inv_tileset_w;
+            q->v0 = (float)sy * map->inv_tileset_h;
+            q->u1 = (float)(sx + map->tile_w) * map->inv_tileset_w;
+            q->v1 = (float)(sy + map->tile_h) * map->inv_tileset_h;
+        }
+    }
+    return n;
+}
+
+#endif // BM_CONFIG_NO_TILEMAPS
+
+// ------------------------------------------------------------
+// Particles
+// ------------------------------------------------------------
+
+#ifndef BM_CONFIG_NO_PARTICLES
+struct BM_ParticleEmitter {
+    // SoA storage, one block, each array padded to a multiple of 4
+    float*   block;
+    float*   x;
+    float*   y;
+    float*   vx;
+    float*   vy;
+    float*   age;
+    float*   inv_life;
+    float*   t;
+    int      capacity;
+    int      count;
+
+    float    gravity_x;
+    float    gravity_y;
+    float    size;
+    BM_Color color_start;
+    BM_Color color_end;
+};
+
+BM_ParticleEmitter*
+bm_particles_create(int capacity)
+{
+    if (capacity <= 0) return NULL;
+
+    BM_ParticleEmitter* e = (BM_ParticleEmitter*)calloc(1, sizeof(BM_ParticleEmitter));
+    if (!e) return NULL;
+
+    size_t stride = ((size_t)capacity + 3) & ~(size_t)3;
+    e->block = (float*)malloc(stride * 7 * sizeof(float));
+    if (!e->block) {
+        free(e);
+        return NULL;
+    }
+    e->x        = e->block;
+    e->y        = e->x  + stride;
+    e->vx       = e->y  + stride;
+    e->vy       = e->vx + stride;
+    e->age      = e->vy + stride;
+    e->inv_life = e->age + stride;
+    e->t        = e->inv_life + stride;
+
+    e->capacity    = capacity;
+    e->size        = 1.0f;
+    e->color_start = bm_color_rgba(1.0f, 1.0f, 1.0f, 1.0f);
+    e->color_end   = bm_color_rgba(1.0f, 1.0f, 1.0f, 0.0f);
+    return e;
+}
+
+void
+bm_particles_destroy(BM_ParticleEmitter* emitter)
+{
+    if (!emitter) return;
+    free(emitter->block);
+    free(emitter);
+}
+
+void
+bm_particles_set_gravity(BM_ParticleEmitter* emitter, float gx, float gy)
+{
+    if (!emitter) return;
+    emitter->gravity_x = gx;
+    emitter->gravity_y = gy;
+}
+
+void
+bm_particles_set_colors(BM_ParticleEmitter* emitter, BM_Color start, BM_Color end)
+{
+    if (!emitter) return;
+    emitter->color_start = start;
+    emitter->color_end   = end;
+}
+
+void
+bm_particles_set_size(BM_ParticleEmitter* emitter, float size)
+{
+    if (!emitter) return;
+    emitter->size = size;
+}
+
+int
+bm_particles_emit(BM_ParticleEmitter* emitter,
+                  float x, float y, float vx, float vy,
+                  float lifetime)
+{
+    if (!emitter || emitter->count >= emitter->capacity) return 0;
+    if (lifetime <= 0.0f) return 1;  // dead on arrival
+
+    int i = emitter->count++;
+    emitter->x[i]        = x;
+    emitter->y[i]        = y;
+    emitter->vx[i]       = vx;
+    emitter->vy[i]       = vy;
+    emitter->age[i]      = 0.0f;
+    emitter->inv_life[i] = 1.0f / lifetime;
+    emitter->t[i]        = 0.0f;
+    return 1;
+}
+
+void
+bm_particles_update(BM_ParticleEmitter* emitter, float dt)
+{
+    if (!emitter || emitter->count == 0) return;
+    BM_PROFILE_BEGIN("bm_particles_update");
+
+    BM_ParticleEmitter* e = emitter;
+    float gx = e->gravity_x * dt;
+    float gy = e->gravity_y * dt;
+    int   n  = e->count;
+    int   i  = 0;
+
+    // 1) Integrate: 4 lanes at a time, scalar tail.
+#ifdef BM__SSE2
+    __m128 vdt = _mm_set1_ps(dt);
+    __m128 vgx = _mm_set1_ps(gx);
+    __m128 vgy = _mm_set1_ps(gy);
+    for (; i + 4 <= n; i += 4) {
+        __m128 vx  = _mm_loadu_ps(e->vx + i);
+        __m128 vy  = _mm_loadu_ps(e->vy + i);
+        __m128 age = _mm_add_ps(_mm_loadu_ps(e->age + i), vdt);
+        _mm_storeu_ps(e->x + i, _mm_add_ps(_mm_loadu_ps(e->x + i), _mm_mul_ps(vx, vdt)));
+        _mm_storeu_ps(e->y + i, _mm_add_ps(_mm_loadu_ps(e->y + i), _mm_mul_ps(vy, vdt)));
+        _mm_storeu_ps(e->vx + i, _mm_add_ps(vx, vgx));
+        _mm_storeu_ps(e->vy + i, _mm_add_ps(vy, vgy));
+        _mm_storeu_ps(e->age + i, age);
+        _mm_storeu_ps(e->t + i, _mm_mul_ps(age, _mm_loadu_ps(e->inv_life + i)));
+    }
+#endif
+    for (; i < n; ++i) {
+        e->x[i]   += e->vx[i] * dt;
+        e->y[i]   += e->vy[i] * dt;
+        e->vx[i]  += gx;
+        e->vy[i]  += gy;
+        e->age[i] += dt;
+        e->t[i]    = e->age[i] * e->inv_life[i];
+    }
+
+    // 2) Remove dead particles (swap with last, order not kept).
+    for (i = 0; i < n; ) {
+        if (e->t[i] < 1.0f) {
+            ++i;
+            continue;
+        }
+        --n;
+        e->x[i]        = e->x[n];
+        e->y[i]        = e->y[n];
+        e->vx[i]       = e->vx[n];
+        e->vy[i]       = e->vy[n];
+        e->age[i]      = e->age[n];
+        e->inv_life[i] = e->inv_life[n];
+        e->t[i]        = e->t[n];
+    }
+    e->count = n;
+    BM_PROFILE_END("bm_particles_update");
+}
+
+int
+bm_particles_count(const BM_ParticleEmitter* emitter)
+{
+    return emitter ? emitter->count : 0;
+}
+
+void
+bm_particles(BM_ParticleEmitter* emitter)
+{
+    BM__CHECK_CTX();
+    if (!emitter || emitter->count == 0) return;
+    BM_Command* cmd = bm__push_command(g_bm_ctx);
+    if (!cmd) return;
+
+    cmd->type   = BM_CMD_PARTICLES;
+    cmd->color  = g_bm_ctx->draw_color;
+    cmd->object = emitter;
+    cmd->count  = (uint32_t)emitter->count;
+    cmd->w      = emitter->size;
+    cmd->h      = emitter->size;
+}
+
+void
+bm_particles_get_view(const BM_Command* cmd, BM_ParticleView* out_view)
+{
+    if (!out_view) return;
+    memset(out_view, 0, sizeof(*out_view));
+    if (!cmd || cmd->type != BM_CMD_PARTICLES || !cmd->object) return;
+
+    const BM_ParticleEmitter* e = (const BM_ParticleEmitter*)cmd->object;
+    out_view->x           = e->x;
+    out_view->y           = e->y;
+    out_view->t           = e->t;
+    out_view->count       = (int)cmd->count < e->count ? (int)cmd->count : e->count;
+    out_view->size        = e->size;
+    out_view->color_start = e->color_start;
+    out_view->color_end   = e->color_end;
+}
+
+#endif // BM_CONFIG_NO_PARTICLES
+
+// ------------------------------------------------------------
+// Command merging
+// ------------------------------------------------------------
+
+#ifndef BM_CONFIG_NO_MERGE
+// Conservative bounds of what a command may touch; 0 if unknown
+// (text, tilemaps, particles), which blocks any merge across it.
+static int
+bm__command_bounds(const BM_Command* c, float* x0, float* y0, float* x1, float* y1)
+{
+    switch (c->type) {
+    case BM_CMD_RECT_FILL:
+    case BM_CMD_RECT_OUTLINE:
+    case BM_CMD_SPRITE:
+        *x0 = c->w < 0 ? c->x + c->w : c->x;
+        *y0 = c->h < 0 ? c->y + c->h : c->y;
+        *x1 = c->w < 0 ? c->x : c->x + c->w;
+        *y1 = c->h < 0 ? c->y : c->y + c->h;
+        return 1;
+    // Shapes are anti-aliased or rounded outward: pad by a pixel.
+    case BM_CMD_LINE:
+        *x0 = (c->x < c->x2 ? c->x : c->x2) - 1.0f;
+        *y0 = (c->y < c->y2 ? c->y : c->y2) - 1.0f;
+        *x1 = (c->x > c->x2 ? c->x : c->x2) + 1.0f;
+        *y1 = (c->y > c->y2 ? c->y : c->y2) + 1.0f;
+        return 1;
+    case BM_CMD_ELLIPSE_FILL:
+    case BM_CMD_ELLIPSE_OUTLINE:
+        *x0 = c->x - c->w - 1.0f;
+        *y0 = c->y - c->h - 1.0f;
+        *x1 = c->x + c->w + 1.0f;
+        *y1 = c->y + c->h + 1.0f;
+        return 1;
+    case BM_CMD_POLYGON_FILL:
+    case BM_CMD_POLYGON_OUTLINE:
+    case BM_CMD_POLYLINE:
+        *x0 = c->x - 1.0f;
+        *y0 = c->y - 1.0f;
+        *x1 = c->x + c->w + 1.0f;
+        *y1 = c->y + c->h + 1.0f;
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+// Grows `dst` to dst + src if they share a whole edge and the union
+// is exact in float, so backends rasterize the same pixels.
+static int
+bm__rect_union(BM_Command* dst, const BM_Command* src)
+{
+    float x = dst->x, y = dst->y, w = dst->w, h = dst->h;
+    if (y == src->y && h == src->h) {
+        if (x + w == src->x) {
+            w = (src->x + src->w) - x;
+            if (x + w != src->x + src->w) return 0;
+        } else if (src->x + src->w == x) {
+            w = (x + w) - src->x;
+            if (src->x + w != dst->x + dst->w) return 0;
+            x = src->x;
+        } else {
+            return 0;
+        }
+    } else if (x == src->x && w == src->w) {
+        if (y + h == src->y) {
+            h = (src->y + src->h) - y;
+            if (y + h != src->y + src->h) return 0;
+        } else if (src->y + src->h == y) {
+            h = (y + h) - src->y;
+            if (src->y + h != dst->y + dst->h) return 0;
+            y = src->y;
+        } else {
+            return 0;
+        }
+    } else {
+        return 0;
+    }
+    dst->x = x;
+    dst->y = y;
+    dst->w = w;
+    dst->h = h;
+    return 1;
+}
+
+// One compaction sweep: each rect fill either merges into an earlier
+// one reachable without crossing an overlapping command, or stays.
+static size_t
+bm__merge_sweep(BM_Context* ctx)
+{
+    size_t out = 0;
+    for (size_t i = 0; i < ctx->count; ++i) {
+        BM_Command b = *BM__CMD(ctx, i);  // the out slot may alias i
+        if (b.type == BM_CMD_RECT_FILL && b.w > 0.0f && b.h > 0.0f) {
+            float  bx1  = b.x + b.w, by1 = b.y + b.h;
+            size_t stop = out > BM_MERGE_WINDOW ? out - BM_MERGE_WINDOW : 0;
+            int    merged = 0;
+            for (size_t k = out; k-- > stop; ) {
+                BM_Command* c = BM__CMD(ctx, k);
+                // Backends disagree on negative sizes: never grow one.
+                if (c->type == BM_CMD_RECT_FILL && c->w > 0.0f && c->h > 0.0f &&
+                    c->color.r == b.color.r && c->color.g == b.color.g &&
+                    c->color.b == b.color.b && c->color.a == b.color.a &&
+                    c->color.index == b.color.index &&
+                    bm__rect_union(c, &b)) {
+                    merged = 1;
+                    break;
+                }
+                float x0, y0, x1, y1;
+                if (!bm__command_bounds(c, &x0, &y0, &x1, &y1)) break;
+                if (x0 < bx1 && b.x < x1 && y0 < by1 && b.y < y1) break;
+            }
+            if (merged) continue;
+        }
+        *BM__CMD(ctx, out) = b;
+        out++;
+    }
+    size_t removed = ctx->count - out;
+    ctx->count = out;
+    return removed;
+}
+
+// Horizontal runs merge in the first sweep; the rows they form only
+// line up for vertical merges in the next, so sweep to a fixpoint.
+static size_t
+bm__merge_rect_fills(BM_Context* ctx)
+{
+    BM_PROFILE_BEGIN("bm_merge_rect_fills");
+    size_t removed = 0;
+    for (int pass = 0; pass < 4; ++pass) {
+        size_t n = bm__merge_sweep(ctx);
+        removed += n;
+        if (n == 0) break;
+    }
+    BM_PROFILE_COUNTER("bm_merged_commands", removed);
+    BM_PROFILE_END("bm_merge_rect_fills");
+    return removed;
+}
+
+size_t
+bm_merge_rect_fills(BM_Context* ctx)
+{
+    if (!ctx) return 0;
+    size_t removed = bm__merge_rect_fills(ctx);
+#ifdef BM_ENABLE_STATS
+    // The frame's stats were taken in bm_end_frame; amend them.
+    BM_FrameStats* st = &ctx->stats;
+    st->merged_count  += removed;
+    st->command_count  = ctx->count;
+    st->commands_by_type[BM_CMD_RECT_FILL] -= removed;
+    st->bytes_recorded -= removed * sizeof(BM_Command);
+#endif
+    return removed;
+}
+
+void
+bm_set_rect_merging(int enable)
+{
+    BM__CHECK_CTX();
+    g_bm_ctx->merge_rects = enable ? 1 : 0;
+}
+
+#endif // BM_CONFIG_NO_MERGE
+
+// ------------------------------------------------------------
+// Concurrent submission
+// ------------------------------------------------------------
+
+#ifndef BM_CONFIG_NO_SUBMIT
+// Grows the slot table to at least `slots` (whole blocks). Only
+// called while sealed, so no producer is looking at it.
+static int
+bm__submit_grow(BM_Context* ctx, size_t slots)
+{
+    size_t old_cap = (size_t)ctx->submit_capacity;
+    size_t old_n   = old_cap / ctx->block_size;
+    size_t new_n   = (slots + ctx->block_size - 1) / ctx->block_size;
+    if (new_n <= old_n) return 1;
+    if (new_n > ((size_t)BM__SUBMIT_SEALED >> 1) / ctx->block_size ||
+        new_n > (size_t)-1 / ctx->block_size / sizeof(BM__SubmitSlot)) {
+        return 0;
+    }
+    size_t new_cap = new_n * ctx->block_size;
+
+    BM_Command** blocks =
+        (BM_Command**)realloc(ctx->submit_blocks, new_n * sizeof(BM_Command*));
+    if (!blocks) return 0;
+    ctx->submit_blocks = blocks;
+
+    BM__SubmitSlot* meta =
+        (BM__SubmitSlot*)realloc(ctx->submit_slots, new_cap * sizeof(BM__SubmitSlot));
+    if (!meta) return 0;
+    ctx->submit_slots = meta;
+    memset(meta + old_cap, 0, (new_cap - old_cap) * sizeof(BM__SubmitSlot));
+
+    BM__SubmitSort* sort =
+        (BM__SubmitSort*)realloc(ctx->submit_sort, new_cap * sizeof(BM__SubmitSort));
+    if (!sort) return 0;
+    ctx->submit_sort = sort;
+
+    BM_PROFILE_BEGIN("bm_grow_submit");
+    size_t n = old_n;
+    while (n < new_n) {
+        blocks[n] = (BM_Command*)bm__bulk_alloc(ctx, ctx->block_bytes);
+        if (!blocks[n]) break;
+        n++;
+    }
+    BM_PROFILE_END("bm_grow_submit");
+    BM__ATOMIC_STORE(&ctx->submit_capacity, (int64_t)(n * ctx->block_size));
+    return n == new_n;
+}
+
+static void
+bm__submit_open(BM_Context* ctx)
+{
+    if (ctx->submit_demand > (size_t)ctx->submit_capacity) {
+        bm__submit_grow(ctx, ctx->submit_demand);
+    }
+#ifdef BM_ENABLE_STATS
+    ctx->submitted_count = 0;
+    ctx->submit_dropped  = 0;
+#endif
+    // Publishes capacity, blocks and frame_index to producers.
+    BM__ATOMIC_STORE(&ctx->submit_next, (int64_t)0);
+}
+
+static int
+bm__submit_compare(const void* a, const void* b)
+{
+    const BM__SubmitSort* x = (const BM__SubmitSort*)a;
+    const BM__SubmitSort* y = (const BM__SubmitSort*)b;
+    if (x->key != y->key) return x->key < y->key ? -1 : 1;
+    return memcmp(x->cmd, y->cmd, sizeof(BM_Command));
+}
+
+// Seals the table, waits for every reserved slot to be written and
+// appends the slots in key order.
+static void
+bm__submit_close(BM_Context* ctx)
+{
+    int64_t reserved = BM__ATOMIC_XCHG(&ctx->submit_next, BM__SUBMIT_SEALED);
+    if (reserved <= 0 || reserved >= BM__SUBMIT_SEALED) return;  // not open / none
+
+    size_t n        = (size_t)reserved;
+    size_t capacity = (size_t)ctx->submit_capacity;
+    if (n > capacity) {
+        ctx->submit_demand = n;
+#ifdef BM_ENABLE_STATS
+        ctx->submit_dropped = n - capacity;
+#endif
+        n = capacity;
+    }
+    if (n == 0) return;
+
+    BM_PROFILE_BEGIN("bm_submit_merge");
+    int64_t epoch = (int64_t)ctx->frame_index;
+    for (size_t i = 0; i < n; ++i) {
+        // A producer between its reservation and its publish is a
+        // handful of stores away from done.
+        while (BM__ATOMIC_LOAD(&ctx->submit_slots[i].epoch) != epoch) {
+            BM__SPIN_PAUSE();
+        }
+        ctx->submit_sort[i].key = ctx->submit_slots[i].key;
+        ctx->submit_sort[i].cmd = BM__CMD_IN(ctx, ctx->submit_blocks, i);
+    }
+    qsort(ctx->submit_sort, n, sizeof(BM__SubmitSort), bm__submit_compare);
+
+    size_t appended = 0;
+    for (size_t i = 0; i < n; ++i) {
+        BM_Command* cmd = bm__push_command(ctx);
+        if (!cmd) break;
+        *cmd = *ctx->submit_sort[i].cmd;
+        appended++;
+    }
+#ifdef BM_ENABLE_STATS
+    ctx->submitted_count = appended;
+#else
+    (void)appended;
+#endif
+    BM_PROFILE_END("bm_submit_merge");
+}
+
+void
+bm_reserve_submit_slots(BM_Context* ctx, size_t count)
+{
+    if (!ctx) return;
+    if (count > ctx->submit_demand) {
+        ctx->submit_demand = count;
+    }
+    if (BM__ATOMIC_LOAD(&ctx->submit_next) >= BM__SUBMIT_SEALED) {
+        bm__submit_grow(ctx, ctx->submit_demand);
+    }
+}
+
+int
+bm_submit(BM_Context* ctx, uint64_t key, const BM_Command* cmd)
+{
+    if (!ctx || !cmd) return 0;
+    switch (cmd->type) {
+    case BM_CMD_RECT_FILL:
+    case BM_CMD_RECT_OUTLINE:
+    case BM_CMD_LINE:
+    case BM_CMD_SPRITE:
+#ifndef BM_CONFIG_NO_SHAPES
+    case BM_CMD_ELLIPSE_FILL:
+    case BM_CMD_ELLIPSE_OUTLINE:
+#endif
+        break;
+    default:
+        return 0;  // needs the arena or per-context caches
+    }
+
+    int64_t i = BM__ATOMIC_ADD(&ctx->submit_next, (int64_t)1);
+    if (i >= BM__ATOMIC_LOAD(&ctx->submit_capacity)) return 0;  // full or sealed
+
+    BM_Command* dst = BM__CMD_IN(ctx, ctx->submit_blocks, (size_t)i);
+    *dst = *cmd;
+    dst->object = NULL;
+    dst->first  = 0;
+    dst->count  = 0;
+    ctx->submit_slots[i].key = key;
+    BM__ATOMIC_STORE(&ctx->submit_slots[i].epoch, (int64_t)ctx->frame_index);
+    return 1;
+}
+
+#endif // BM_CONFIG_NO_SUBMIT
+
+// ------------------------------------------------------------
+// Frame statistics
+// ------------------------------------------------------------
+
+#ifdef BM_ENABLE_STATS
+
+double
+bm_time_seconds(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart / (double)freq.QuadPart;
+#elif defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#else
+    // Strict ISO C build without POSIX: processor time only.
+    return (double)clock() / (double)CLOCKS_PER_SEC;
+#endif
+}
+
+static void
+bm__stats_end_frame(BM_Context* ctx)
+{
+    BM_FrameStats* st = &ctx->stats;
+    BM_BackendStats backend = st->backend;
+
+    memset(st, 0, sizeof(*st));
+    st->backend        = backend;
+    st->command_count  = ctx->count;
+    st->capacity       = ctx->block_count * ctx->block_size;
+    st->realloc_count  = ctx->realloc_count;
+    st->merged_count   = ctx->merged_count;
+    st->culled_count   = ctx->culled_count;
+    st->submitted_count = ctx->submitted_count;
+    st->submit_dropped  = ctx->submit_dropped;
+    st->bytes_recorded = ctx->count * sizeof(BM_Command) + ctx->arena_used;
+    st->arena_used       = ctx->arena_used;
+    st->arena_capacity   = ctx->arena_capacity;
+    st->arena_high_water = ctx->arena_high_water;
+
+    for (size_t b = 0; b * ctx->block_size < ctx->count; ++b) {
+        const BM_Command* cmds = ctx->blocks[b];
+        size_t n = ctx->count - b * ctx->block_size;
+        if (n > ctx->block_size) n = ctx->block_size;
+        for (size_t i = 0; i < n; ++i) {
+            int type = (int)cmds[i].type;
+            if (type > 0 && type < BM_CMD_COUNT) {
+                st->commands_by_type[type]++;
+            }
+        }
+    }
+
+    if (ctx->count > ctx->high_water) {
+        ctx->high_water = ctx->count;
+    }
+    st->high_water     = ctx->high_water;
+    st->record_seconds = bm_time_seconds() - ctx->frame_start;
+
+    if (ctx->stats_callback) {
+        ctx->stats_callback(st, ctx->stats_user);
+    }
+}
+
+void
+bm_get_frame_stats(const BM_Context* ctx, BM_FrameStats* out_stats)
+{
+    if (!ctx || !out_stats) return;
+    *out_stats = ctx->stats;
+}
+
+void
+bm_set_frame_stats_callback(BM_FrameStatsCallback callback, void* user)
+{
+    BM__CHECK_CTX();
+    g_bm_ctx->stats_callback = callback;
+    g_bm_ctx->stats_user     = user;
+}
+
+void
+bm_report_backend_stats(BM_Context* ctx, const BM_BackendStats* stats)
+{
+    if (!ctx || !stats) return;
+    ctx->stats.backend = *stats;
+}
+
+#endif // BM_ENABLE_STATS
+
+// ------------------------------------------------------------
+// Frame capture
+// ------------------------------------------------------------
+
+#ifdef BM_ENABLE_CAPTURE
+
+struct BM_CaptureFile {
+    unsigned char* data;
+    size_t         size;
+    size_t*        frame_offsets;  // offset of each BM_CaptureFrameHeader
+    BM_Command**   frame_commands; // one-block views, see bm_capture_get_frame
+    int            frame_count;
+#ifdef _WIN32
+    HANDLE         file;
+    HANDLE         mapping;
+#endif
+};
+
+// Command bytes of a captured frame, padded so its arena is aligned.
+static size_t
+bm__capture_commands_size(size_t count)
+{
+    size_t n = count * sizeof(BM_Command);
+    return (n + BM_ARENA_ALIGN - 1) & ~(size_t)(BM_ARENA_ALIGN - 1);
+}
+
+static void
+bm__capture_write_frame(BM_Context* ctx)
+{
+    if (ctx->count > 0xFFFFFFFFu) {
+        // Frame headers count commands in 32 bits.
+        fclose(ctx->capture);
+        ctx->capture = NULL;
+        return;
+    }
+
+    BM_CaptureFrameHeader fh;
+    memset(&fh, 0, sizeof(fh));
+    fh.magic          = BM_CAPTURE_FRAME_MAGIC;
+    fh.command_count  = (uint32_t)ctx->count;
+    fh.logical_width  = ctx->logical_width;
+    fh.logical_height = ctx->logical_height;
+    fh.clear_color    = ctx->clear_color;
+    // Padded so the next frame's commands stay aligned.
+    size_t arena_size = (ctx->arena_used + BM_ARENA_ALIGN - 1) &
+                        ~(size_t)(BM_ARENA_ALIGN - 1);
+    fh.arena_size     = (uint32_t)arena_size;
+#ifndef BM_CONFIG_NO_PALETTE
+    if (ctx->palette_size > 0 && ctx->palette_offset != 0xFFFFFFFFu) {
+        fh.palette_size   = (uint32_t)ctx->palette_size;
+        fh.palette_offset = ctx->palette_offset;
+    }
+#endif
+    if (arena_size > ctx->arena_used) {
+        // Arena capacity is a multiple of BM_ARENA_ALIGN, so the
+        // padding is in bounds; zero it for reproducible files.
+        memset(ctx->arena + ctx->arena_used, 0, arena_size - ctx->arena_used);
+    }
+
+    // Commands go through a staging copy with the host object
+    // cleared, as bm_submit does; the live frame keeps its pointers
+    // for the backend.
+    BM_Command staging[128];
+    int ok = fwrite(&fh, sizeof(fh), 1, ctx->capture) == 1;
+    for (size_t i = 0; ok && i < ctx->count; ) {
+        size_t n = 0;
+        for (; n < 128 && i < ctx->count; ++n, ++i) {
+            staging[n] = *BM__CMD(ctx, i);
+            staging[n].object = NULL;
+        }
+        ok = fwrite(staging, sizeof(BM_Command), n, ctx->capture) == n;
+    }
+    static const unsigned char pad[BM_ARENA_ALIGN] = {0};
+    size_t pad_size = bm__capture_commands_size(ctx->count) -
+                      ctx->count * sizeof(BM_Command);
+    if (ok && pad_size > 0) {
+        ok = fwrite(pad, 1, pad_size, ctx->capture) == pad_size;
+    }
+    if (!ok ||
+        (arena_size > 0 &&
+         fwrite(ctx->arena, 1, arena_size, ctx->capture) != arena_size)) {
+        // Disk full or similar: stop capturing rather than write
+        // a truncated frame on every subsequent call.
+        fclose(ctx->capture);
+        ctx->capture = NULL;
+    }
+}
+
+int
+bm_capture_begin(const char* path)
+{
+    if (!g_bm_ctx || !path) return 0;
+    bm_capture_end();
+
+    FILE* f = fopen(path, "wb");
+    if (!f) return 0;
+
+    BM_CaptureFileHeader h;
+    h.magic        = BM_CAPTURE_MAGIC;
+    h.version      = BM_CAPTURE_VERSION;
+    h.command_size = (uint32_t)sizeof(BM_Command);
+    h.endian_tag   = BM_CAPTURE_ENDIAN_TAG;
+    if (fwrite(&h, sizeof(h), 1, f) != 1) {
+        fclose(f);
+        return 0;
+    }
+
+    g_bm_ctx->capture = f;
+    return 1;
+}
+
+void
+bm_capture_end(void)
+{
+    if (!g_bm_ctx || !g_bm_ctx->capture) return;
+    fclose(g_bm_ctx->capture);
+    g_bm_ctx->capture = NULL;
+}
+
+static void
+bm__capture_unmap(BM_CaptureFile* file)
+{
+#ifdef _WIN32
+    if (file->data)    UnmapViewOfFile(file->data);
+    if (file->mapping) CloseHandle(file->mapping);
+    if (file->file && file->file != INVALID_HANDLE_VALUE) {
+        CloseHandle(file->file);
+    }
+#else
+    if (file->data) munmap(file->data, file->size);
+#endif
+    file->data = NULL;
+}
+
+static int
+bm__capture_map(BM_CaptureFile* file, const char* path)
+{
+#ifdef _WIN32
+    file->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file->file == INVALID_HANDLE_VALUE) return 0;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file->file, &size) || size.QuadPart == 0) return 0;
+    file->size = (size_t)size.QuadPart;
+
+    file->mapping = CreateFileMappingA(file->file, NULL, PAGE_READONLY,
+                                       0, 0, NULL);
+    if (!file->mapping) return 0;
+    file->data = (unsigned char*)MapViewOfFile(file->mapping,
+                                               FILE_MAP_READ, 0, 0, 0);
+    return file->data != NULL;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return 0;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return 0;
+    }
+    file->size = (size_t)st.st_size;
+
+    // Read-only: a write through a BM_CommandView faults instead of
+    // silently copying the page.
+    void* p = mmap(NULL, file->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return 0;
+    file->data = (unsigned char*)p;
+    return 1;
+#endif
+}
+
+BM_CaptureFile*
+bm_capture_open(const char* path)
+{
+    if (!path) return NULL;
+
+    BM_CaptureFile* file = (BM_CaptureFile*)calloc(1, sizeof(BM_CaptureFile));
+    if (!file) return NULL;
+
+    if (!bm__capture_map(file, path) ||
+        file->size < sizeof(BM_CaptureFileHeader)) {
+        bm_capture_close(file);
+        return NULL;
+    }
+
+    BM_CaptureFileHeader h;
+    memcpy(&h, file->data, sizeof(h));
+    if (h.magic != BM_CAPTURE_MAGIC ||
+        h.version != BM_CAPTURE_VERSION ||
+        h.command_size != (uint32_t)sizeof(BM_Command) ||
+        h.endian_tag != BM_CAPTURE_ENDIAN_TAG) {
+        bm_capture_close(file);
+        return NULL;
+    }
+
+    // Index frames up front so bm_capture_get_frame() is O(1).
+    int    frame_cap = 0;
+    size_t offset    = sizeof(BM_CaptureFileHeader);
+    while (file->size - offset >= sizeof(BM_CaptureFrameHeader)) {
+        BM_CaptureFrameHeader fh;
+        memcpy(&fh, file->data + offset, sizeof(fh));
+        size_t body = bm__capture_commands_size(fh.command_count) +
+                      (size_t)fh.arena_size;
+        if (fh.magic != BM_CAPTURE_FRAME_MAGIC ||
+            file->size - offset - sizeof(fh) < body) {
+            break;  // truncated tail (e.g. crash mid-capture)
+        }
+        const BM_Command* cmds =
+            (const BM_Command*)(file->data + offset + sizeof(fh));
+        uint32_t i = 0;
+        while (i < fh.command_count && !cmds[i].object) ++i;
+        if (i < fh.command_count) {
+            break;  // corrupt: a host pointer must never be followed
+        }
+
+        if (file->frame_count == frame_cap) {
+            int     new_cap = frame_cap ? frame_cap * 2 : 64;
+            size_t* new_offsets = (size_t*)realloc(
+                file->frame_offsets, (size_t)new_cap * sizeof(size_t));
+            if (new_offsets) file->frame_offsets = new_offsets;
+            BM_Command** new_commands = (BM_Command**)realloc(
+                file->frame_commands, (size_t)new_cap * sizeof(BM_Command*));
+            if (new_commands) file->frame_commands = new_commands;
+            if (!new_offsets || !new_commands) {
+                bm_capture_close(file);
+                return NULL;
+            }
+            frame_cap = new_cap;
+        }
+        file->frame_offsets[file->frame_count]  = offset;
+        file->frame_commands[file->frame_count] = (BM_Command*)cmds;
+        file->frame_count++;
+        offset += sizeof(fh) + body;
+    }
+
+    return file;
+}
+
+void
+bm_capture_close(BM_CaptureFile* file)
+{
+    if (!file) return;
+    bm__capture_unmap(file);
+    free(file->frame_offsets);
+    free(file->frame_commands);
+    free(file);
+}
+
+int
+bm_capture_frame_count(const BM_CaptureFile* file)
+{
+    return file ? file->frame_count : 0;
+}
+
+int
+bm_capture_get_frame(const BM_CaptureFile* file,
+                     int                   index,
+                     BM_CaptureFrame*      out_frame)
+{
+    if (!file || !out_frame) return 0;
+    if (index < 0 || index >= file->frame_count) return 0;
+
+    unsigned char* p = file->data + file->frame_offsets[index];
+    BM_CaptureFrameHeader fh;
+    memcpy(&fh, p, sizeof(fh));
+
+    // A capture frame is one contiguous block.
+    out_frame->view.blocks      = (BM_Command* const*)&file->frame_commands[index];
+    out_frame->view.block_size  = fh.command_count ? fh.command_count : 1;
+    out_frame->view.count       = fh.command_count;
+    out_frame->view.arena       = (const unsigned char*)file->frame_commands[index] +
+                                  bm__capture_commands_size(fh.command_count);
+    out_frame->view.arena_size  = fh.arena_size;
+    out_frame->view.palette      = NULL;
+    out_frame->view.palette_size = 0;
+    if (fh.palette_size > 0 && fh.palette_size <= BM_PALETTE_SIZE) {
+        out_frame->view.palette = (const uint32_t*)bm_command_payload(
+            &out_frame->view, fh.palette_offset, fh.palette_size * sizeof(uint32_t));
+        if (out_frame->view.palette) {
+            out_frame->view.palette_size = (int)fh.palette_size;
+        }
+    }
+    out_frame->logical_width  = fh.logical_width;
+    out_frame->logical_height = fh.logical_height;
+    out_frame->clear_color    = fh.clear_color;
+    return 1;
+}
+
+#endif // BM_ENABLE_CAPTURE
+
 #endif // BANGERMAN_IMPLEMENTATION_DONE
 #endif // BANGERMAN_IMPLEMENTATION
@@ -0,0 +1,412 @@
+// bench/bm_bench.c
+//
+// Synthetic benchmark suite: canned 2D workloads measured for
+// recording throughput (bm_rect_fill / bm_line / bm_sprite ...)
+// and replay throughput through the SDL3 software renderer and
+// the CPU backend. Results are printed as JSON for trending.
+//
+//   bm_bench [--frames N] [--size WxH] [--scenario NAME] [--merge]
+//
+// --merge runs bm_merge_rect_fills() after every frame and reports
+// how many commands it removed.
+//
+// Compile with:
+//
+//   cc bm_bench.c -O2 -I../ -lSDL3 -lm -o bm_bench
+//   cc bm_bench.c -O2 -I../ -DBM_BENCH_NO_SDL3 -lm -o bm_bench   // CPU only
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L  // clock_gettime
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BANGERMAN_IMPLEMENTATION
+#include "../bangerman.h"
+#include "../renderers/CPU/bm_renderer_CPU.c"
+
+#ifndef BM_BENCH_NO_SDL3
+#include <SDL3/SDL.h>
+#include "../renderers/SDL3/bm_renderer_SDL3.c"
+#endif
+
+// ------------------------------------------------------------
+// Helpers
+// ------------------------------------------------------------
+
+static double
+now_seconds(void)
+{
+#ifndef BM_BENCH_NO_SDL3
+    return (double)SDL_GetTicksNS() * 1e-9;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+// xorshift32: deterministic, identical workloads on every run.
+static uint32_t g_rng = 0x9E3779B9u;
+
+static void
+rng_seed(uint32_t seed)
+{
+    g_rng = seed ? seed : 0x9E3779B9u;
+}
+
+static float
+rng_float(void)
+{
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return (float)(g_rng >> 8) * (1.0f / 16777216.0f);
+}
+
+// ------------------------------------------------------------
+// Scenarios
+// ------------------------------------------------------------
+
+// 100k particles: one small rect fill each, per-particle color.
+static void
+scenario_particles(int frame)
+{
+    rng_seed(1234u + (uint32_t)frame);
+    for (int i = 0; i < 100000; ++i) {
+        float life = rng_float();
+        bm_set_draw_color(bm_color_rgba(1.0f, 0.6f * life, 0.1f, life));
+        bm_rect_fill(rng_float() * 320.0f, rng_float() * 180.0f, 2.0f, 2.0f);
+    }
+}
+
+// 1M particles through an emitter: respawn + SIMD update + one
+// bm_particles command. "record" here is simulate + record.
+static BM_ParticleEmitter *g_emitter = NULL;
+
+static void
+scenario_emitter(int frame)
+{
+    (void)frame;
+    if (!g_emitter) {
+        g_emitter = bm_particles_create(1000000);
+        if (!g_emitter) return;
+        bm_particles_set_gravity(g_emitter, 0.0f, 40.0f);
+        bm_particles_set_size(g_emitter, 2.0f);
+        bm_particles_set_colors(g_emitter,
+                                bm_color_rgba(1.0f, 0.8f, 0.2f, 1.0f),
+                                bm_color_rgba(1.0f, 0.1f, 0.0f, 0.0f));
+        rng_seed(4321u);
+    }
+    while (bm_particles_emit(g_emitter,
+                             160.0f, 90.0f,
+                             (rng_float() - 0.5f) * 200.0f,
+                             (rng_float() - 0.5f) * 200.0f,
+                             0.5f + rng_float() * 2.0f)) {
+    }
+    bm_particles_update(g_emitter, 1.0f / 60.0f);
+    bm_set_draw_color(bm_color_rgb(1.0f, 1.0f, 1.0f));
+    bm_particles(g_emitter);
+}
+
+// 256x256 tilemap of 16x16 sprites, scrolled by the frame index.
+static void
+scenario_tilemap(int frame)
+{
+    float camX = (float)(frame * 3);
+    float camY = (float)(frame * 2);
+    bm_set_draw_color(bm_color_rgb(1.0f, 1.0f, 1.0f));
+    for (int ty = 0; ty < 256; ++ty) {
+        for (int tx = 0; tx < 256; ++tx) {
+            BM_TextureId tile = (BM_TextureId)((tx * 7 + ty * 13) & 15);
+            bm_sprite(tile, tx * 16.0f - camX, ty * 16.0f - camY, 16.0f, 16.0f);
+        }
+    }
+}
+
+// UI: nested panels with borders (windows > groups > widgets).
+// There is no clip command yet; nesting is expressed purely as
+// overlapping fills + outlines, which is what the UI emits today.
+static void
+scenario_ui_nested(int frame)
+{
+    (void)frame;
+    for (int win = 0; win < 8; ++win) {
+        float wx = 4.0f + (float)(win % 4) * 79.0f;
+        float wy = 4.0f + (float)(win / 4) * 88.0f;
+        bm_set_draw_color(bm_color_rgba(0.1f, 0.1f, 0.15f, 0.9f));
+        bm_rect_fill(wx, wy, 75.0f, 84.0f);
+        bm_set_draw_color(bm_color_rgb(0.6f, 0.6f, 0.7f));
+        bm_rect_outline(wx, wy, 75.0f, 84.0f);
+
+        for (int grp = 0; grp < 4; ++grp) {
+            float gx = wx + 2.0f;
+            float gy = wy + 2.0f + (float)grp * 20.5f;
+            bm_set_draw_color(bm_color_rgba(0.2f, 0.2f, 0.25f, 0.9f));
+            bm_rect_fill(gx, gy, 71.0f, 19.0f);
+            bm_set_draw_color(bm_color_rgb(0.4f, 0.4f, 0.5f));
+            bm_rect_outline(gx, gy, 71.0f, 19.0f);
+
+            for (int w = 0; w < 64; ++w) {
+                float bx = gx + 1.0f + (float)(w % 16) * 4.4f;
+                float by = gy + 1.0f + (float)(w / 16) * 4.4f;
+                bm_set_draw_color(bm_color_rgb(0.3f, 0.5f, 0.8f));
+                bm_rect_fill(bx, by, 4.0f, 4.0f);
+                bm_set_draw_color(bm_color_rgb(0.9f, 0.9f, 1.0f));
+                bm_rect_outline(bx, by, 4.0f, 4.0f);
+            }
+        }
+    }
+}
+
+// Dense line plot: 1M segments of a noisy signal across the canvas.
+static void
+scenario_lineplot(int frame)
+{
+    rng_seed(99u + (uint32_t)frame);
+    bm_set_draw_color(bm_color_rgba(0.2f, 1.0f, 0.4f, 0.5f));
+    const int n = 1000000;
+    float px = 0.0f;
+    float py = 90.0f;
+    for (int i = 1; i <= n; ++i) {
+        float x = (float)i * (320.0f / (float)n);
+        float y = 90.0f + (rng_float() - 0.5f) * 160.0f;
+        bm_line(px, py, x, y);
+        px = x;
+        py = y;
+    }
+}
+
+// Same signal as one polyline: 100k points, one command.
+static void
+scenario_polyline(int frame)
+{
+    static BM_Point pts[100000];
+    const int n = (int)(sizeof(pts) / sizeof(pts[0]));
+    rng_seed(99u + (uint32_t)frame);
+    for (int i = 0; i < n; ++i) {
+        pts[i].x = (float)i * (320.0f / (float)n);
+        pts[i].y = 90.0f + (rng_float() - 0.5f) * 160.0f;
+    }
+    bm_set_draw_color(bm_color_rgba(0.2f, 1.0f, 0.4f, 0.5f));
+    bm_polyline(pts, n, 1.5f);
+}
+
+// Procedural level: one unit rect per cell, sky / grass / dirt /
+// stone bands over a height map with ore veins, as the generator
+// emits it (row-major, 320x180 = 57600 fills).
+static void
+scenario_level(int frame)
+{
+    const BM_Color sky   = bm_color_rgb(0.45f, 0.7f, 1.0f);
+    const BM_Color grass = bm_color_rgb(0.2f, 0.7f, 0.2f);
+    const BM_Color dirt  = bm_color_rgb(0.5f, 0.35f, 0.2f);
+    const BM_Color stone = bm_color_rgb(0.4f, 0.4f, 0.45f);
+    const BM_Color ore   = bm_color_rgb(0.9f, 0.8f, 0.2f);
+    (void)frame;
+    for (int y = 0; y < 180; ++y) {
+        for (int x = 0; x < 320; ++x) {
+            int ground = 90 + ((x / 16) * 37 % 11) - 5;
+            BM_Color c = sky;
+            if (y == ground)          c = grass;
+            else if (y > ground + 12) c = ((x / 4 + y / 3) % 23 == 0) ? ore : stone;
+            else if (y > ground)      c = dirt;
+            bm_set_draw_color(c);
+            bm_rect_fill((float)x, (float)y, 1.0f, 1.0f);
+        }
+    }
+}
+
+typedef struct {
+    const char *name;
+    void      (*record)(int frame);
+} Scenario;
+
+static const Scenario g_scenarios[] = {
+    { "particles_100k",   scenario_particles },
+    { "emitter_1m",       scenario_emitter   },
+    { "tilemap_256x256",  scenario_tilemap   },
+    { "ui_nested",        scenario_ui_nested },
+    { "lineplot_1m",      scenario_lineplot  },
+    { "polyline_100k",    scenario_polyline  },
+    { "level_rects",      scenario_level     },
+};
+
+// ------------------------------------------------------------
+// Measurement
+// ------------------------------------------------------------
+
+typedef struct {
+    double seconds;
+    double commands;
+} Measure;
+
+static void
+print_measure(const char *key, Measure m, int frames, int last)
+{
+    double secs = m.seconds > 0.0 ? m.seconds : 1e-12;
+    printf("      \"%s\": { \"mean_frame_ms\": %.4f, \"commands_per_sec\": %.0f }%s\n",
+           key, m.seconds / frames * 1e3, m.commands / secs, last ? "" : ",");
+}
+
+static void
+usage(void)
+{
+    fprintf(stderr,
+            "usage: bm_bench [--frames N] [--size WxH] [--scenario NAME] "
+            "[--merge]\n");
+}
+
+int main(int argc, char **argv)
+{
+    int         frames = 10;
+    int         width  = 1280;
+    int         height = 720;
+    const char *only   = NULL;
+    int         merge  = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--frames") && i + 1 < argc) {
+            frames = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--size") && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &width, &height) != 2) {
+                usage();
+                return 1;
+            }
+        } else if (!strcmp(argv[i], "--scenario") && i + 1 < argc) {
+            only = argv[++i];
+        } else if (!strcmp(argv[i], "--merge")) {
+            merge = 1;
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (frames < 1 || width < 1 || height < 1) {
+        usage();
+        return 1;
+    }
+
+    BM_Context *bm = bm_create(1024);
+    if (!bm) return 1;
+    bm_make_current(bm);
+    bm_set_logical_size(320.0f, 180.0f);
+    bm_set_clear_color(bm_color_rgba(0.05f, 0.05f, 0.1f, 1.0f));
+
+    BM_CPURenderer cpu = {0};
+    cpu.pixels = (uint32_t *)malloc((size_t)width * (size_t)height * sizeof(uint32_t));
+    cpu.width  = width;
+    cpu.height = height;
+    if (!cpu.pixels) return 1;
+
+#ifndef BM_BENCH_NO_SDL3
+    SDL_Surface  *surface  = SDL_CreateSurface(width, height, SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer *renderer = surface ? SDL_CreateSoftwareRenderer(surface) : NULL;
+    if (!renderer) {
+        fprintf(stderr, "bm_bench: SDL software renderer failed: %s\n", SDL_GetError());
+        return 1;
+    }
+    BM_SDL3Renderer sdl = {0};
+    sdl.renderer = renderer;
+#endif
+
+    printf("{\n");
+    printf("  \"suite\": \"bangerman\",\n");
+    printf("  \"frames\": %d,\n", frames);
+    printf("  \"output_size\": [%d, %d],\n", width, height);
+    printf("  \"scenarios\": [\n");
+
+    int count   = (int)(sizeof(g_scenarios) / sizeof(g_scenarios[0]));
+    int printed = 0;
+    for (int s = 0; s < count; ++s) {
+        const Scenario *sc = &g_scenarios[s];
+        if (only && strcmp(only, sc->name) != 0) continue;
+
+        // Warm-up frame so buffer growth is not measured.
+        bm_begin_frame();
+        sc->record(0);
+        bm_end_frame();
+        if (merge) bm_merge_rect_fills(bm);
+
+        Measure rec  = {0};
+        Measure mrg  = {0};
+        Measure cpuM = {0};
+#ifndef BM_BENCH_NO_SDL3
+        Measure sdlM = {0};
+#endif
+        for (int f = 0; f < frames; ++f) {
+            double t0 = now_seconds();
+            bm_begin_frame();
+            sc->record(f);
+            bm_end_frame();
+            double t1 = now_seconds();
+
+            BM_CommandView view = {0};
+            bm_get_commands(bm, &view);
+            rec.seconds  += t1 - t0;
+            rec.commands += view.count;
+
+            if (merge) {
+                mrg.commands += view.count;
+                t0 = now_seconds();
+                bm_merge_rect_fills(bm);
+                t1 = now_seconds();
+                mrg.seconds += t1 - t0;
+                bm_get_commands(bm, &view);
+            }
+
+#ifndef BM_BENCH_NO_SDL3
+            t0 = now_seconds();
+            BM_SDL3_Render(&sdl, bm);
+            SDL_FlushRenderer(renderer);
+            t1 = now_seconds();
+            sdlM.seconds  += t1 - t0;
+            sdlM.commands += view.count;
+#endif
+
+            t0 = now_seconds();
+            BM_CPU_Render(&cpu, bm);
+            t1 = now_seconds();
+            cpuM.seconds  += t1 - t0;
+            cpuM.commands += view.count;
+        }
+
+        if (printed++) printf(",\n");
+        printf("    {\n");
+        printf("      \"name\": \"%s\",\n", sc->name);
+        printf("      \"commands_per_frame\": %.0f,\n", rec.commands / frames);
+        // The emitter records one command; report its particle load too.
+        if (sc->record == scenario_emitter) {
+            printf("      \"particles_per_frame\": %d,\n", bm_particles_count(g_emitter));
+        }
+        print_measure("record", rec, frames, 0);
+        if (merge) {
+            // Replay below runs on the merged frame.
+            printf("      \"merged_commands_per_frame\": %.0f,\n",
+                   cpuM.commands / frames);
+            printf("      \"merge_ratio\": %.4f,\n",
+                   rec.commands > 0.0 ? 1.0 - cpuM.commands / rec.commands : 0.0);
+            print_measure("merge", mrg, frames, 0);
+        }
+#ifndef BM_BENCH_NO_SDL3
+        print_measure("replay_sdl3_software", sdlM, frames, 0);
+#endif
+        print_measure("replay_cpu", cpuM, frames, 1);
+        printf("    }");
+        fflush(stdout);
+    }
+    printf("\n  ]\n}\n");
+
+#ifndef BM_BENCH_NO_SDL3
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroySurface(surface);
+#endif
+    bm_particles_destroy(g_emitter);
+    BM_CPU_Destroy(&cpu);
+    free(cpu.pixels);
+    bm_destroy(bm);
+    return 0;
+}
@@ -0,0 +1,164 @@
+// bench/bm_bench_config.c
+//
+// Build-configuration benchmark: the rect-fill + sprite workload of
+// a game that needs nothing else, recorded and replayed through the
+// CPU backend. Build it once as is and once with the command set cut
+// down (see "Build configuration" in bangerman.h) to compare the
+// recording hot path and code size. Results are printed as JSON like
+// bm_bench.
+//
+//   bm_bench_config [--frames N] [--commands N]
+//
+// Compile with:
+//
+//   cc bm_bench_config.c -O2 -I../ -lm -o bm_bench_full
+//   cc bm_bench_config.c -O2 -I../ -DBM_CONFIG_MINIMAL
+//      -DBM_CONFIG_NO_CONTEXT_CHECKS -DNDEBUG -lm -o bm_bench_minimal
+//   size bm_bench_full bm_bench_minimal
+//
+// Small --commands keep the frame in cache, so the record time is
+// the call path rather than memory bandwidth.
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L  // clock_gettime
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BANGERMAN_IMPLEMENTATION
+#include "../bangerman.h"
+#include "../renderers/CPU/bm_renderer_CPU.c"
+
+// ------------------------------------------------------------
+// Helpers
+// ------------------------------------------------------------
+
+static double
+now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// xorshift32: deterministic, identical workloads on every run.
+static uint32_t g_rng = 0x9E3779B9u;
+
+static float
+rng_float(void)
+{
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return (float)(g_rng >> 8) * (1.0f / 16777216.0f);
+}
+
+// Positions are generated up front so the timed loop is only the
+// recording calls.
+typedef struct {
+    float x, y;
+} Spot;
+
+static void
+record_frame(const Spot *spots, int commands)
+{
+    bm_begin_frame();
+    for (int i = 0; i < commands; ++i) {
+        if (i & 3) {
+            bm_rect_fill(spots[i].x, spots[i].y, 4.0f, 4.0f);
+        } else {
+            bm_sprite(1, spots[i].x, spots[i].y, 8.0f, 8.0f);
+        }
+    }
+    bm_end_frame();
+}
+
+static void
+usage(void)
+{
+    fprintf(stderr, "usage: bm_bench_config [--frames N] [--commands N]\n");
+}
+
+int main(int argc, char **argv)
+{
+    int frames   = 200;
+    int commands = 100000;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--frames") && i + 1 < argc) {
+            frames = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--commands") && i + 1 < argc) {
+            commands = atoi(argv[++i]);
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (frames < 1 || commands < 1) {
+        usage();
+        return 1;
+    }
+
+    Spot     *spots  = (Spot *)malloc((size_t)commands * sizeof(Spot));
+    uint32_t *sprite = (uint32_t *)malloc(8 * 8 * sizeof(uint32_t));
+    BM_CPURenderer cpu = {0};
+    cpu.width  = 640;
+    cpu.height = 360;
+    cpu.pixels = malloc((size_t)cpu.width * (size_t)cpu.height * sizeof(uint32_t));
+    BM_Context *ctx = bm_create(commands);
+    if (!spots || !sprite || !cpu.pixels || !ctx) return 1;
+
+    for (int i = 0; i < commands; ++i) {
+        spots[i].x = rng_float() * 316.0f;
+        spots[i].y = rng_float() * 176.0f;
+    }
+    for (int i = 0; i < 8 * 8; ++i) sprite[i] = 0xFF40C0FFu;
+    BM_CPU_SetTexture(&cpu, 1, sprite, 8, 8);
+
+    bm_make_current(ctx);
+    bm_set_logical_size(320.0f, 180.0f);
+    bm_set_draw_color(bm_color_rgb(1.0f, 0.5f, 0.25f));
+    record_frame(spots, commands);  // warm-up: blocks allocated
+
+    double record = 0.0;
+    double replay = 0.0;
+    for (int f = 0; f < frames; ++f) {
+        double t0 = now_seconds();
+        record_frame(spots, commands);
+        double t1 = now_seconds();
+        BM_CPU_Render(&cpu, ctx);
+        double t2 = now_seconds();
+        record += t1 - t0;
+        replay += t2 - t1;
+    }
+
+    const char *config = "full";
+#ifdef BM_CONFIG_MINIMAL
+    config = "minimal";
+#endif
+
+    printf("{\n");
+    printf("  \"suite\": \"bangerman_config\",\n");
+    printf("  \"config\": \"%s\",\n", config);
+#ifdef BM_CONFIG_NO_CONTEXT_CHECKS
+    printf("  \"context_checks\": false,\n");
+#else
+    printf("  \"context_checks\": true,\n");
+#endif
+    printf("  \"frames\": %d,\n", frames);
+    printf("  \"commands_per_frame\": %d,\n", commands);
+    printf("  \"record_ms\": %.4f,\n", record / frames * 1e3);
+    printf("  \"record_ns_per_command\": %.2f,\n", record / frames / commands * 1e9);
+    printf("  \"cpu_replay_ms\": %.4f\n", replay / frames * 1e3);
+    printf("}\n");
+
+    BM_CPU_Destroy(&cpu);
+    free(cpu.pixels);
+    free(sprite);
+    free(spots);
+    bm_destroy(ctx);
+    return 0;
+}
@@ -0,0 +1,302 @@
+// bench/bm_bench_pipeline.c
+//
+// Frame-timing benchmark for the two-phase SDL3 backend: the same
+// workload rendered serially (record, prepare, submit, present) and
+// pipelined (a worker prepares frame N + 1 while the main thread
+// submits and presents frame N). Uses SDL's software renderer on an
+// offscreen surface, so no GPU or display is needed. Results are
+// printed as JSON like bm_bench.
+//
+//   bm_bench_pipeline [--frames N] [--commands N] [--size WxH]
+//                     [--threads N] [--canvas]
+//
+// --threads sets BM_SDL3Renderer.threads for the prepare phase
+// (frames of BM_SDL3_PARALLEL_MIN commands or more are split).
+// prepare_ns_per_command is the transform + vertex cost per command;
+// build with -DBM_SDL3_NO_SIMD to compare against the scalar path.
+// --canvas rasterizes at logical size and upscales once
+// (BM_SDL3Renderer.logicalCanvas); compare submit_present_ms.
+//
+// Compile with:
+//
+//   cc bm_bench_pipeline.c -O2 -I../ -lSDL3 -lm -o bm_bench_pipeline
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <SDL3/SDL.h>
+
+#define BANGERMAN_IMPLEMENTATION
+#include "../bangerman.h"
+#include "../renderers/SDL3/bm_renderer_SDL3.c"
+
+// ------------------------------------------------------------
+// Helpers
+// ------------------------------------------------------------
+
+static double
+now_seconds(void)
+{
+    return (double)SDL_GetTicksNS() * 1e-9;
+}
+
+static int
+compare_doubles(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// xorshift32: deterministic, identical workloads on every run.
+static uint32_t g_rng = 0x9E3779B9u;
+
+static float
+rng_float(void)
+{
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return (float)(g_rng >> 8) * (1.0f / 16777216.0f);
+}
+
+// Mixed scene: mostly rect fills, some outlines, lines and circles.
+static void
+record_frame(BM_Context *ctx, int frame, int commands)
+{
+    g_rng = 0x9E3779B9u ^ (uint32_t)(frame * 7919);
+    bm_make_current(ctx);
+    bm_begin_frame();
+    for (int i = 0; i < commands; ++i) {
+        float x = rng_float() * 320.0f;
+        float y = rng_float() * 180.0f;
+        bm_set_draw_color(bm_color_rgba(rng_float(), rng_float(), rng_float(), 1.0f));
+        switch (i & 15) {
+        case 13: bm_rect_outline(x, y, 6.0f, 4.0f); break;
+        case 14: bm_line(x, y, x + 8.0f, y + 3.0f); break;
+        case 15: bm_circle_fill(x, y, 3.0f); break;
+        default: bm_rect_fill(x, y, 2.0f, 2.0f); break;
+        }
+    }
+    bm_end_frame();
+}
+
+// ------------------------------------------------------------
+// Prepare worker
+// ------------------------------------------------------------
+
+typedef struct {
+    SDL_Semaphore   *go;
+    SDL_Semaphore   *done;
+    BM_SDL3Renderer *renderer;
+    BM_SDL3Batch    *batch;    // set by the main thread before `go`
+    const BM_Context *ctx;
+    int              outputW;
+    int              outputH;
+    int              quit;
+    double           seconds;  // last prepare
+} PrepareWorker;
+
+static int
+prepare_thread(void *arg)
+{
+    PrepareWorker *w = (PrepareWorker *)arg;
+    for (;;) {
+        SDL_WaitSemaphore(w->go);
+        if (w->quit) break;
+        double t0 = now_seconds();
+        BM_SDL3_Prepare(w->renderer, w->batch, w->ctx, w->outputW, w->outputH);
+        w->seconds = now_seconds() - t0;
+        SDL_SignalSemaphore(w->done);
+    }
+    return 0;
+}
+
+// ------------------------------------------------------------
+// Report
+// ------------------------------------------------------------
+
+typedef struct {
+    double record;
+    double prepare;
+    double submit;  // submit + flush ("present")
+} PhaseTotals;
+
+static void
+print_mode(const char *name, double *samples, int frames, int commands,
+           const PhaseTotals *ph, int last)
+{
+    double total = 0.0;
+    for (int i = 0; i < frames; ++i) total += samples[i];
+    qsort(samples, (size_t)frames, sizeof(double), compare_doubles);
+    int p99 = (int)((double)frames * 0.99);
+    if (p99 >= frames) p99 = frames - 1;
+
+    printf("    \"%s\": {\n", name);
+    printf("      \"mean_frame_ms\": %.4f,\n", total / frames * 1e3);
+    printf("      \"p50_frame_ms\": %.4f,\n", samples[frames / 2] * 1e3);
+    printf("      \"p99_frame_ms\": %.4f,\n", samples[p99] * 1e3);
+    printf("      \"fps\": %.1f,\n", total > 0.0 ? frames / total : 0.0);
+    printf("      \"record_ms\": %.4f,\n", ph->record / frames * 1e3);
+    printf("      \"prepare_ms\": %.4f,\n", ph->prepare / frames * 1e3);
+    printf("      \"prepare_ns_per_command\": %.2f,\n",
+           ph->prepare / frames / commands * 1e9);
+    printf("      \"submit_present_ms\": %.4f\n", ph->submit / frames * 1e3);
+    printf("    }%s\n", last ? "" : ",");
+}
+
+static void
+usage(void)
+{
+    fprintf(stderr, "usage: bm_bench_pipeline [--frames N] [--commands N] [--size WxH] "
+                    "[--threads N] [--canvas]\n");
+}
+
+int main(int argc, char **argv)
+{
+    int frames   = 200;
+    int commands = 100000;
+    int width    = 1280;
+    int height   = 720;
+    int threads  = 1;
+    int canvas   = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--frames") && i + 1 < argc) {
+            frames = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--commands") && i + 1 < argc) {
+            commands = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--canvas")) {
+            canvas = 1;
+        } else if (!strcmp(argv[i], "--size") && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &width, &height) != 2) {
+                usage();
+                return 1;
+            }
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (frames < 2 || commands < 1 || width < 1 || height < 1 || threads < 1) {
+        usage();
+        return 1;
+    }
+
+    SDL_Surface  *surface  = SDL_CreateSurface(width, height, SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer *renderer = surface ? SDL_CreateSoftwareRenderer(surface) : NULL;
+    if (!renderer) {
+        fprintf(stderr, "bm_bench_pipeline: SDL software renderer failed: %s\n",
+                SDL_GetError());
+        if (surface) SDL_DestroySurface(surface);
+        return 1;
+    }
+
+    BM_Context *ctx = bm_create(commands);
+    bm_make_current(ctx);
+    bm_set_logical_size(320.0f, 180.0f);
+
+    BM_SDL3Renderer r = {0};
+    r.renderer      = renderer;
+    r.threads       = threads;
+    r.logicalCanvas = canvas;
+
+    double *samples = (double *)malloc((size_t)frames * sizeof(double));
+    if (!ctx || !samples) return 1;
+
+    printf("{\n");
+    printf("  \"suite\": \"bangerman_pipeline\",\n");
+    printf("  \"frames\": %d,\n", frames);
+    printf("  \"commands_per_frame\": %d,\n", commands);
+    printf("  \"output_size\": [%d, %d],\n", width, height);
+    printf("  \"prepare_threads\": %d,\n", threads);
+    printf("  \"logical_canvas\": %s,\n", canvas ? "true" : "false");
+    printf("  \"modes\": {\n");
+
+    // --------------------------------------------------------
+    // Serial: everything on the main thread
+    // --------------------------------------------------------
+    PhaseTotals serial = {0};
+    for (int f = 0; f < frames; ++f) {
+        double t0 = now_seconds();
+        record_frame(ctx, f, commands);
+        double t1 = now_seconds();
+
+        int outputW = 0, outputH = 0;
+        SDL_GetCurrentRenderOutputSize(renderer, &outputW, &outputH);
+        BM_SDL3_Prepare(&r, &r.batch, ctx, outputW, outputH);
+        double t2 = now_seconds();
+
+        BM_SDL3_Submit(&r, &r.batch);
+        SDL_FlushRenderer(renderer);
+        double t3 = now_seconds();
+
+        serial.record  += t1 - t0;
+        serial.prepare += t2 - t1;
+        serial.submit  += t3 - t2;
+        samples[f] = t3 - t0;
+    }
+    print_mode("serial", samples, frames, commands, &serial, 0);
+
+    // --------------------------------------------------------
+    // Pipelined: prepare N + 1 on a worker while N is submitted
+    // --------------------------------------------------------
+    BM_SDL3Batch  batches[2] = { {0}, {0} };
+    PrepareWorker worker     = {0};
+    worker.go       = SDL_CreateSemaphore(0);
+    worker.done     = SDL_CreateSemaphore(0);
+    worker.renderer = &r;
+    worker.ctx      = ctx;
+    SDL_GetCurrentRenderOutputSize(renderer, &worker.outputW, &worker.outputH);
+    SDL_Thread *thread = SDL_CreateThread(prepare_thread, "bm_prepare", &worker);
+    if (!worker.go || !worker.done || !thread) {
+        fprintf(stderr, "bm_bench_pipeline: thread setup failed: %s\n", SDL_GetError());
+        return 1;
+    }
+
+    // Prime: frame 0 prepared up front.
+    record_frame(ctx, 0, commands);
+    BM_SDL3_Prepare(&r, &batches[0], ctx, worker.outputW, worker.outputH);
+
+    PhaseTotals piped = {0};
+    for (int f = 1; f <= frames; ++f) {
+        double t0 = now_seconds();
+        record_frame(ctx, f, commands);
+        double t1 = now_seconds();
+
+        worker.batch = &batches[f & 1];
+        SDL_SignalSemaphore(worker.go);
+
+        BM_SDL3_Submit(&r, &batches[(f - 1) & 1]);
+        SDL_FlushRenderer(renderer);
+        double t2 = now_seconds();
+
+        SDL_WaitSemaphore(worker.done);  // ctx is free to record again
+        double t3 = now_seconds();
+
+        piped.record  += t1 - t0;
+        piped.prepare += worker.seconds;
+        piped.submit  += t2 - t1;
+        samples[f - 1] = t3 - t0;
+    }
+    print_mode("pipelined", samples, frames, commands, &piped, 1);
+    printf("  }\n}\n");
+
+    worker.quit = 1;
+    SDL_SignalSemaphore(worker.go);
+    SDL_WaitThread(thread, NULL);
+    SDL_DestroySemaphore(worker.go);
+    SDL_DestroySemaphore(worker.done);
+
+    BM_SDL3_DestroyBatch(&batches[0]);
+    BM_SDL3_DestroyBatch(&batches[1]);
+    BM_SDL3_Destroy(&r);
+    free(samples);
+    bm_destroy(ctx);
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroySurface(surface);
+    return 0;
+}
@@ -0,0 +1,316 @@
+// bench/bm_bench_tlb.c
+//
+// Large-frame benchmark: records a scatter plot of millions of
+// points into a context backed by malloc and into one backed by
+// extras/large-pages, then walks and replays the frame. Reports
+// time and, where perf events are available (Linux), data-TLB load
+// misses per phase. Results are printed as JSON like bm_bench.
+//
+//   bm_bench_tlb [--commands N] [--frames N] [--node K]
+//
+// Compile with:
+//
+//   cc bm_bench_tlb.c -O2 -I../ -lm -o bm_bench_tlb
+//
+// Transparent huge pages must be "always" or "madvise"
+// (/sys/kernel/mm/transparent_hugepage/enabled), or reserve pages
+// in /proc/sys/vm/nr_hugepages for MAP_HUGETLB.
+
+#if !defined(_WIN32) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE  // MAP_ANONYMOUS, syscall, clock_gettime
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BANGERMAN_IMPLEMENTATION
+#include "../bangerman.h"
+#include "../renderers/CPU/bm_renderer_CPU.c"
+
+#define BM_ALLOC_LARGE_PAGES_IMPLEMENTATION
+#include "../extras/large-pages/bm_alloc_large_pages.h"
+
+#ifdef _WIN32
+#include <windows.h>  // QueryPerformanceCounter
+#endif
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// ------------------------------------------------------------
+// Helpers
+// ------------------------------------------------------------
+
+static double
+now_seconds(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+static uint32_t g_rng = 0x9E3779B9u;
+
+static uint32_t
+rng_next(void)
+{
+    g_rng ^= g_rng << 13;
+    g_rng ^= g_rng >> 17;
+    g_rng ^= g_rng << 5;
+    return g_rng;
+}
+
+// Data-TLB read misses of this thread, user space only; -1 if the
+// counter is unavailable (no PMU in a VM, perf_event_paranoid).
+static int
+tlb_open(void)
+{
+#ifdef __linux__
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type           = PERF_TYPE_HW_CACHE;
+    attr.size           = sizeof(attr);
+    attr.config         = PERF_COUNT_HW_CACHE_DTLB |
+                          (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled       = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+    return -1;
+#endif
+}
+
+static void
+tlb_start(int fd)
+{
+#ifdef __linux__
+    if (fd < 0) return;
+    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#else
+    (void)fd;
+#endif
+}
+
+static double
+tlb_stop(int fd)
+{
+#ifdef __linux__
+    unsigned long long value = 0;
+    if (fd < 0) return -1.0;
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(fd, &value, sizeof(value)) != (ssize_t)sizeof(value)) return -1.0;
+    return (double)value;
+#else
+    (void)fd;
+    return -1.0;
+#endif
+}
+
+// AnonHugePages of the process in kB (transparent huge pages in
+// use), -1 where unknown.
+static long
+thp_kb(void)
+{
+    long  kb = -1;
+#ifdef __linux__
+    FILE *f  = fopen("/proc/self/smaps_rollup", "r");
+    char  line[256];
+    if (!f) return -1;
+    while (fgets(line, sizeof(line), f)) {
+        if (sscanf(line, "AnonHugePages: %ld kB", &kb) == 1) break;
+    }
+    fclose(f);
+#endif
+    return kb;
+}
+
+// ------------------------------------------------------------
+// Phases
+// ------------------------------------------------------------
+
+// Scientific scatter plot: one 1x1 fill per sample.
+static void
+record_scatter(size_t n)
+{
+    g_rng = 0x9E3779B9u;
+    bm_begin_frame();
+    bm_set_draw_color(bm_color_rgba(0.2f, 0.8f, 1.0f, 0.5f));
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t r = rng_next();
+        bm_rect_fill((float)(r % 320u), (float)((r >> 16) % 180u), 1.0f, 1.0f);
+    }
+    bm_end_frame();
+}
+
+// Streaming pass, as a backend replays the frame.
+static double
+walk(const BM_CommandView *view)
+{
+    double sum = 0.0;
+    BM_CommandIter it = bm_command_iter(view);
+    for (const BM_Command *cmd; (cmd = bm_command_next(&it)) != NULL; ) {
+        sum += cmd->x;
+    }
+    return sum;
+}
+
+// Random lookups (picking, sorting by key): the TLB-bound case.
+static double
+gather(const BM_CommandView *view, size_t lookups)
+{
+    double sum = 0.0;
+    g_rng = 12345u;
+    for (size_t i = 0; i < lookups; ++i) {
+        size_t k = ((size_t)rng_next() << 16 ^ rng_next()) % view->count;
+        sum += bm_command_at(view, k)->y;
+    }
+    return sum;
+}
+
+typedef struct {
+    double seconds;
+    double tlb_misses;  // < 0: unavailable
+} Measure;
+
+static void
+print_measure(const char *key, Measure m, int frames, int last)
+{
+    printf("      \"%s\": { \"mean_frame_ms\": %.4f, ", key, m.seconds / frames * 1e3);
+    if (m.tlb_misses >= 0.0) {
+        printf("\"dtlb_misses_per_frame\": %.0f }", m.tlb_misses / frames);
+    } else {
+        printf("\"dtlb_misses_per_frame\": null }");
+    }
+    printf("%s\n", last ? "" : ",");
+}
+
+static void
+usage(void)
+{
+    fprintf(stderr, "usage: bm_bench_tlb [--commands N] [--frames N] [--node K]\n");
+}
+
+int main(int argc, char **argv)
+{
+    size_t commands = (size_t)4 << 20;  // 256 MiB of commands
+    int    frames   = 5;
+    int    node     = -1;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--commands") && i + 1 < argc) {
+            commands = (size_t)strtoull(argv[++i], NULL, 10);
+        } else if (!strcmp(argv[i], "--frames") && i + 1 < argc) {
+            frames = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--node") && i + 1 < argc) {
+            node = atoi(argv[++i]);
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (commands < 1 || frames < 1) {
+        usage();
+        return 1;
+    }
+
+    int tlb = tlb_open();
+
+    BM_CPURenderer cpu = {0};
+    cpu.width  = 640;
+    cpu.height = 360;
+    cpu.pixels = malloc((size_t)cpu.width * (size_t)cpu.height * sizeof(uint32_t));
+    if (!cpu.pixels) return 1;
+
+    printf("{\n");
+    printf("  \"suite\": \"bangerman_tlb\",\n");
+    printf("  \"frames\": %d,\n", frames);
+    printf("  \"commands_per_frame\": %zu,\n", commands);
+    printf("  \"command_bytes\": %zu,\n", commands * sizeof(BM_Command));
+    printf("  \"allocators\": [\n");
+
+    for (int mode = 0; mode < 2; ++mode) {
+        BM_Allocator large = bm_large_page_allocator(node);
+        BM_Context  *bm    = mode ? bm_create_with_allocator(commands, &large)
+                                  : bm_create_sized(commands);
+        if (!bm) {
+            fprintf(stderr, "bm_bench_tlb: out of memory\n");
+            return 1;
+        }
+        bm_make_current(bm);
+        record_scatter(commands);  // first touch outside the timings
+
+        Measure rec = {0}, wlk = {0}, gat = {0}, cpuM = {0};
+        double  sink = 0.0;
+        for (int f = 0; f < frames; ++f) {
+            BM_CommandView view;
+            double t0, m;
+
+            tlb_start(tlb);
+            t0 = now_seconds();
+            record_scatter(commands);
+            rec.seconds += now_seconds() - t0;
+            m = tlb_stop(tlb);
+            rec.tlb_misses = m < 0.0 ? -1.0 : rec.tlb_misses + m;
+
+            bm_get_commands(bm, &view);
+
+            tlb_start(tlb);
+            t0 = now_seconds();
+            sink += walk(&view);
+            wlk.seconds += now_seconds() - t0;
+            m = tlb_stop(tlb);
+            wlk.tlb_misses = m < 0.0 ? -1.0 : wlk.tlb_misses + m;
+
+            tlb_start(tlb);
+            t0 = now_seconds();
+            sink += gather(&view, commands / 4);
+            gat.seconds += now_seconds() - t0;
+            m = tlb_stop(tlb);
+            gat.tlb_misses = m < 0.0 ? -1.0 : gat.tlb_misses + m;
+
+            tlb_start(tlb);
+            t0 = now_seconds();
+            BM_CPU_Render(&cpu, bm);
+            cpuM.seconds += now_seconds() - t0;
+            m = tlb_stop(tlb);
+            cpuM.tlb_misses = m < 0.0 ? -1.0 : cpuM.tlb_misses + m;
+        }
+
+        if (mode) printf(",\n");
+        printf("    {\n");
+        printf("      \"name\": \"%s\",\n", mode ? "large_pages" : "malloc");
+        printf("      \"anon_huge_pages_kb\": %ld,\n", thp_kb());
+        printf("      \"checksum\": %.0f,\n", sink);
+        print_measure("record", rec, frames, 0);
+        print_measure("walk", wlk, frames, 0);
+        print_measure("random_lookup", gat, frames, 0);
+        print_measure("replay_cpu", cpuM, frames, 1);
+        printf("    }");
+        fflush(stdout);
+        bm_destroy(bm);
+    }
+    printf("\n  ]\n}\n");
+
+#ifdef __linux__
+    if (tlb >= 0) close(tlb);
+#endif
+    BM_CPU_Destroy(&cpu);
+    free(cpu.pixels);
+    return 0;
+}
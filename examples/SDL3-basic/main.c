@@ -4,7 +4,7 @@
 
 #define BANGERMAN_IMPLEMENTATION
 #include "../../bangerman.h"
-#include "../../backends/SDL3/bm_renderer_SDL3.c"
+#include "../../renderers/SDL3/bm_renderer_SDL3.c"
 
 int main(int argc, char **argv) {
     (void)argc; (void)argv;
@@ -0,0 +1,204 @@
+// examples/thumbnails/main.c
+//
+// Headless batch rendering: records a few hundred small scenes, one
+// BM_Context each, renders them on a thread pool with the CPU backend
+// and writes some of them out as PNG / PPM. No SDL, no display.
+//
+//   thumbnails [--scenes N] [--size WxH] [--threads N] [--write N]
+//
+// Prints scenes/sec for one thread and for the pool, so the scaling
+// of the render phase can be read off directly.
+//
+// Compile with:
+//
+//   cc main.c -O2 -I../../ -pthread -lm -o thumbnails
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L  // clock_gettime
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#define BANGERMAN_IMPLEMENTATION
+#include "../../bangerman.h"
+#include "../../renderers/CPU/bm_renderer_CPU.c"
+
+#define BM_RENDER_FARM_IMPLEMENTATION
+#include "../../extras/render-farm/bm_render_farm.h"
+
+static double
+now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// Small deterministic generator so every run draws the same scenes.
+static uint32_t
+next_random(uint32_t *state)
+{
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static float
+random_float(uint32_t *state, float lo, float hi)
+{
+    return lo + (hi - lo) * (float)(next_random(state) & 0xFFFFFF) / 16777215.0f;
+}
+
+// Records one scene into `ctx`: sky, hills, a sun and some clutter.
+// Recording goes through the current context, so this is serial.
+static void
+record_scene(BM_Context *ctx, int index)
+{
+    uint32_t rng = 0x9E3779B9u * (uint32_t)(index + 1);
+    float    hue = random_float(&rng, 0.0f, 1.0f);
+
+    bm_make_current(ctx);
+    bm_set_logical_size(320.0f, 180.0f);
+    bm_set_clear_color(bm_color_rgb(0.2f + 0.3f * hue, 0.4f, 0.8f - 0.4f * hue));
+    bm_begin_frame();
+
+    bm_set_draw_color(bm_color_rgb(1.0f, 0.9f, 0.3f));
+    bm_circle_fill(random_float(&rng, 40.0f, 280.0f), random_float(&rng, 20.0f, 60.0f),
+                   random_float(&rng, 10.0f, 24.0f));
+
+    for (int h = 0; h < 3; ++h) {
+        float peak = random_float(&rng, 40.0f, 280.0f);
+        float top  = 90.0f + 25.0f * (float)h - random_float(&rng, 0.0f, 30.0f);
+        bm_set_draw_color(bm_color_rgb(0.1f, 0.35f + 0.15f * (float)h, 0.15f));
+        bm_triangle_fill(peak - 180.0f, 180.0f, peak, top, peak + 180.0f, 180.0f);
+    }
+
+    int clutter = 40 + (int)(next_random(&rng) % 80);
+    for (int i = 0; i < clutter; ++i) {
+        float x = random_float(&rng, 0.0f, 310.0f);
+        float y = random_float(&rng, 90.0f, 170.0f);
+        bm_set_draw_color(bm_color_rgb(random_float(&rng, 0.3f, 1.0f),
+                                       random_float(&rng, 0.2f, 0.6f),
+                                       random_float(&rng, 0.1f, 0.4f)));
+        if (i & 1) {
+            bm_rect_fill(x, y, random_float(&rng, 2.0f, 10.0f), random_float(&rng, 2.0f, 10.0f));
+        } else {
+            bm_line(x, y, x + random_float(&rng, -8.0f, 8.0f), y - random_float(&rng, 4.0f, 16.0f));
+        }
+    }
+
+    bm_set_draw_color(bm_color_rgb(1.0f, 1.0f, 1.0f));
+    bm_rect_outline(0.0f, 0.0f, 320.0f, 180.0f);
+    bm_end_frame();
+}
+
+static void
+usage(void)
+{
+    fprintf(stderr,
+            "usage: thumbnails [--scenes N] [--size WxH] [--threads N] [--write N]\n");
+}
+
+int main(int argc, char **argv)
+{
+    int sceneCount = 256;
+    int width      = 320;
+    int height     = 180;
+    int threads    = 0;  // one per CPU
+    int writeCount = 4;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--scenes") && i + 1 < argc) {
+            sceneCount = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--size") && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &width, &height) != 2) {
+                usage();
+                return 1;
+            }
+        } else if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--write") && i + 1 < argc) {
+            writeCount = atoi(argv[++i]);
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (sceneCount < 1 || width < 1 || height < 1 || threads < 0) {
+        usage();
+        return 1;
+    }
+
+    BM_Context  **scenes = (BM_Context **)calloc((size_t)sceneCount, sizeof(BM_Context *));
+    BM_RenderJob *jobs   = (BM_RenderJob *)calloc((size_t)sceneCount, sizeof(BM_RenderJob));
+    uint32_t     *pixels = (uint32_t *)malloc((size_t)sceneCount * (size_t)width *
+                                              (size_t)height * sizeof(uint32_t));
+    if (!scenes || !jobs || !pixels) {
+        fprintf(stderr, "thumbnails: out of memory\n");
+        return 1;
+    }
+
+    // --------------------------------------------------------
+    // Record (serial)
+    // --------------------------------------------------------
+    double t0 = now_seconds();
+    for (int i = 0; i < sceneCount; ++i) {
+        scenes[i] = bm_create(256);
+        if (!scenes[i]) {
+            fprintf(stderr, "thumbnails: bm_create failed\n");
+            return 1;
+        }
+        record_scene(scenes[i], i);
+
+        jobs[i].ctx    = scenes[i];
+        jobs[i].pixels = pixels + (size_t)i * (size_t)width * (size_t)height;
+        jobs[i].width  = width;
+        jobs[i].height = height;
+    }
+    double recordTime = now_seconds() - t0;
+
+    // --------------------------------------------------------
+    // Render: one thread, then the pool
+    // --------------------------------------------------------
+    t0 = now_seconds();
+    int ok1 = bm_render_farm(jobs, sceneCount, 1, NULL);
+    double serialTime = now_seconds() - t0;
+
+    t0 = now_seconds();
+    int okN = bm_render_farm(jobs, sceneCount, threads, NULL);
+    double poolTime = now_seconds() - t0;
+
+    // --------------------------------------------------------
+    // Write a few, alternating PNG and PPM
+    // --------------------------------------------------------
+    char (*paths)[32] = (char (*)[32])calloc((size_t)sceneCount, 32);
+    int written = 0;
+    if (writeCount > sceneCount) writeCount = sceneCount;
+    for (int i = 0; paths && i < writeCount; ++i) {
+        snprintf(paths[i], 32, "thumb_%04d.%s", i, (i & 1) ? "ppm" : "png");
+        written += bm_write_image(paths[i], (const uint32_t *)jobs[i].pixels,
+                                  width, height, 0);
+    }
+
+    printf("scenes:           %d at %dx%d\n", sceneCount, width, height);
+    printf("record ms:        %.3f\n", recordTime * 1e3);
+    printf("render 1 thread:  %.3f ms, %.0f scenes/sec (%d ok)\n",
+           serialTime * 1e3, serialTime > 0.0 ? sceneCount / serialTime : 0.0, ok1);
+    printf("render pool:      %.3f ms, %.0f scenes/sec (%d ok, %d threads)\n",
+           poolTime * 1e3, poolTime > 0.0 ? sceneCount / poolTime : 0.0, okN,
+           threads ? threads : bm_farm__cpu_count());
+    printf("speedup:          %.2fx\n", poolTime > 0.0 ? serialTime / poolTime : 0.0);
+    printf("images written:   %d\n", written);
+
+    free(paths);
+    for (int i = 0; i < sceneCount; ++i) bm_destroy(scenes[i]);
+    free(pixels);
+    free(jobs);
+    free(scenes);
+    return (ok1 == sceneCount && okN == sceneCount) ? 0 : 1;
+}
@@ -0,0 +1,182 @@
+// ============================================================
+// bm_profile_chrome — reference BM_PROFILE_* hook implementation
+// BangDev / Crayon playground
+// ------------------------------------------------------------
+// - Writes Chrome trace-event JSON (chrome://tracing, Perfetto)
+// - Zones become "B"/"E" events, counters become "C" events
+// - Thread-safe; one global trace file per process
+// ============================================================
+//
+// Usage:
+//
+//   // Include BEFORE bangerman.h and the backends, in every file
+//   // whose zones you want to see:
+//   #include "extras/chrome-trace/bm_profile_chrome.h"
+//   #include "bangerman.h"
+//
+//   // In ONE .c file, additionally:
+//   #define BM_PROFILE_CHROME_IMPLEMENTATION
+//
+//   bm_chrome_trace_open("trace.json");
+//   ... frames ...
+//   bm_chrome_trace_close();
+//
+// ============================================================
+
+#ifndef BM_PROFILE_CHROME_H
+#define BM_PROFILE_CHROME_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int  bm_chrome_trace_open(const char* path);  // 1 on success
+void bm_chrome_trace_close(void);
+
+void bm_chrome_trace_begin(const char* name);
+void bm_chrome_trace_end(const char* name);
+void bm_chrome_trace_counter(const char* name, double value);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#define BM_PROFILE_BEGIN(name)          bm_chrome_trace_begin(name)
+#define BM_PROFILE_END(name)            bm_chrome_trace_end(name)
+#define BM_PROFILE_COUNTER(name, value) bm_chrome_trace_counter(name, (double)(value))
+
+#endif // BM_PROFILE_CHROME_H
+
+// ============================================================
+// IMPLEMENTATION
+// ============================================================
+
+#ifdef BM_PROFILE_CHROME_IMPLEMENTATION
+#ifndef BM_PROFILE_CHROME_IMPLEMENTATION_DONE
+#define BM_PROFILE_CHROME_IMPLEMENTATION_DONE
+
+#include <stdio.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#endif
+
+static FILE* g_bm_chrome_file  = NULL;
+static int   g_bm_chrome_first = 1;   // no comma before the first event
+
+#ifdef _WIN32
+static SRWLOCK g_bm_chrome_lock = SRWLOCK_INIT;
+#define BM_CHROME__LOCK()   AcquireSRWLockExclusive(&g_bm_chrome_lock)
+#define BM_CHROME__UNLOCK() ReleaseSRWLockExclusive(&g_bm_chrome_lock)
+#else
+static pthread_mutex_t g_bm_chrome_lock = PTHREAD_MUTEX_INITIALIZER;
+#define BM_CHROME__LOCK()   pthread_mutex_lock(&g_bm_chrome_lock)
+#define BM_CHROME__UNLOCK() pthread_mutex_unlock(&g_bm_chrome_lock)
+#endif
+
+// Microseconds, the unit trace-event "ts" expects.
+static double
+bm_chrome__now_us(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart * 1e6 / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e6 + (double)ts.tv_nsec * 1e-3;
+#endif
+}
+
+static unsigned long
+bm_chrome__thread_id(void)
+{
+#ifdef _WIN32
+    return (unsigned long)GetCurrentThreadId();
+#else
+    // Only used as an opaque lane id by the viewer.
+    return (unsigned long)(size_t)pthread_self() & 0x7FFFFFFFul;
+#endif
+}
+
+static void
+bm_chrome__event(const char* name, char phase, double value)
+{
+    if (!g_bm_chrome_file) return;
+    double        ts  = bm_chrome__now_us();
+    unsigned long tid = bm_chrome__thread_id();
+
+    BM_CHROME__LOCK();
+    if (g_bm_chrome_file) {
+        fputs(g_bm_chrome_first ? "\n" : ",\n", g_bm_chrome_file);
+        g_bm_chrome_first = 0;
+        if (phase == 'C') {
+            fprintf(g_bm_chrome_file,
+                    "{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,"
+                    "\"tid\":%lu,\"args\":{\"value\":%g}}",
+                    name, ts, tid, value);
+        } else {
+            fprintf(g_bm_chrome_file,
+                    "{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,"
+                    "\"tid\":%lu}",
+                    name, phase, ts, tid);
+        }
+    }
+    BM_CHROME__UNLOCK();
+}
+
+int
+bm_chrome_trace_open(const char* path)
+{
+    bm_chrome_trace_close();
+
+    FILE* f = fopen(path, "w");
+    if (!f) return 0;
+    fputs("[", f);
+
+    BM_CHROME__LOCK();
+    g_bm_chrome_file  = f;
+    g_bm_chrome_first = 1;
+    BM_CHROME__UNLOCK();
+    return 1;
+}
+
+void
+bm_chrome_trace_close(void)
+{
+    BM_CHROME__LOCK();
+    FILE* f = g_bm_chrome_file;
+    g_bm_chrome_file = NULL;
+    BM_CHROME__UNLOCK();
+
+    if (!f) return;
+    fputs("\n]\n", f);
+    fclose(f);
+}
+
+void
+bm_chrome_trace_begin(const char* name)
+{
+    bm_chrome__event(name, 'B', 0.0);
+}
+
+void
+bm_chrome_trace_end(const char* name)
+{
+    bm_chrome__event(name, 'E', 0.0);
+}
+
+void
+bm_chrome_trace_counter(const char* name, double value)
+{
+    bm_chrome__event(name, 'C', value);
+}
+
+#endif // BM_PROFILE_CHROME_IMPLEMENTATION_DONE
+#endif // BM_PROFILE_CHROME_IMPLEMENTATION
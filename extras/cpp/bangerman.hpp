@@ -0,0 +1,171 @@
+// ============================================================
+// bangerman.hpp — C++ recorder with a compile-time command set
+// BangDev / Crayon playground
+// ------------------------------------------------------------
+// - bm::Recorder<Features> records into one context; it only has
+//   the methods of the command groups in Features (SFINAE), so a
+//   stray command type is a compile error at the call
+// - Features must also be compiled in (BM_CONFIG_*, see
+//   bangerman.h), checked once per Recorder type
+// - Header only, C++11; every call forwards to the C API
+// ============================================================
+//
+// Usage:
+//
+//   // Same BM_CONFIG_* defines as the .c file that holds
+//   // BANGERMAN_IMPLEMENTATION, e.g. -DBM_CONFIG_MINIMAL.
+//   #include "bangerman.h"
+//   #include "extras/cpp/bangerman.hpp"
+//
+//   using Recorder = bm::Recorder<bm::kRects | bm::kSprites>;
+//
+//   Recorder rec(ctx);
+//   rec.begin();
+//   rec.color(bm_color_rgb(1.0f, 0.5f, 0.0f));
+//   rec.rect_fill(10.0f, 10.0f, 16.0f, 16.0f);
+//   rec.sprite(hero, x, y, 16.0f, 16.0f);
+//   // rec.line(...);  error: no matching member (kLines not in Features)
+//   rec.end();
+//
+// Build with BM_CONFIG_NO_CONTEXT_CHECKS as well: a Recorder makes
+// its context current in begin(), so the checks can never fail.
+//
+// ============================================================
+
+#ifndef BANGERMAN_HPP
+#define BANGERMAN_HPP
+
+#include <type_traits>
+
+namespace bm {
+
+// Command groups, OR-ed into a Recorder's Features.
+enum Feature : unsigned {
+    kRects     = 1u << 0,  // BM_CMD_RECT_FILL, BM_CMD_RECT_OUTLINE
+    kLines     = 1u << 1,
+    kSprites   = 1u << 2,
+    kShapes    = 1u << 3,  // ellipses, polygons, polylines
+    kText      = 1u << 4,
+    kTilemaps  = 1u << 5,
+    kParticles = 1u << 6,
+};
+
+// Groups this build of bangerman.h provides; Recorder<kCompiled>
+// can record everything.
+constexpr unsigned kCompiled = kRects | kLines | kSprites
+#ifndef BM_CONFIG_NO_SHAPES
+                             | kShapes
+#endif
+#ifndef BM_CONFIG_NO_TEXT
+                             | kText
+#endif
+#ifndef BM_CONFIG_NO_TILEMAPS
+                             | kTilemaps
+#endif
+#ifndef BM_CONFIG_NO_PARTICLES
+                             | kParticles
+#endif
+                             ;
+
+namespace detail {
+// Template parameter type that only exists if Have includes Group.
+template <unsigned Have, unsigned Group>
+using Requires = typename std::enable_if<(Have & Group) != 0, int>::type;
+} // namespace detail
+
+template <unsigned Features>
+class Recorder {
+    static_assert((Features & ~kCompiled) == 0,
+                  "Recorder uses a command group compiled out by BM_CONFIG_*");
+
+public:
+    explicit Recorder(BM_Context* ctx) : ctx_(ctx) {}
+
+    BM_Context* context() const { return ctx_; }
+
+    void begin() {
+        bm_make_current(ctx_);
+        bm_begin_frame();
+    }
+    void end() { bm_end_frame(); }
+
+    void color(BM_Color c) { bm_set_draw_color(c); }
+
+    template <unsigned F = Features, detail::Requires<F, kRects> = 0>
+    void rect_fill(float x, float y, float w, float h) {
+        bm_rect_fill(x, y, w, h);
+    }
+    template <unsigned F = Features, detail::Requires<F, kRects> = 0>
+    void rect_outline(float x, float y, float w, float h) {
+        bm_rect_outline(x, y, w, h);
+    }
+
+    template <unsigned F = Features, detail::Requires<F, kLines> = 0>
+    void line(float x0, float y0, float x1, float y1) {
+        bm_line(x0, y0, x1, y1);
+    }
+
+    template <unsigned F = Features, detail::Requires<F, kSprites> = 0>
+    void sprite(BM_TextureId texture, float x, float y, float w, float h) {
+        bm_sprite(texture, x, y, w, h);
+    }
+
+#ifndef BM_CONFIG_NO_SHAPES
+    template <unsigned F = Features, detail::Requires<F, kShapes> = 0>
+    void circle_fill(float cx, float cy, float radius) {
+        bm_circle_fill(cx, cy, radius);
+    }
+    template <unsigned F = Features, detail::Requires<F, kShapes> = 0>
+    void circle_outline(float cx, float cy, float radius) {
+        bm_circle_outline(cx, cy, radius);
+    }
+    template <unsigned F = Features, detail::Requires<F, kShapes> = 0>
+    void ellipse_fill(float cx, float cy, float rx, float ry) {
+        bm_ellipse_fill(cx, cy, rx, ry);
+    }
+    template <unsigned F = Features, detail::Requires<F, kShapes> = 0>
+    void ellipse_outline(float cx, float cy, float rx, float ry) {
+        bm_ellipse_outline(cx, cy, rx, ry);
+    }
+    template <unsigned F = Features, detail::Requires<F, kShapes> = 0>
+    void polygon_fill(const BM_Point* points, int count) {
+        bm_polygon_fill(points, count);
+    }
+    template <unsigned F = Features, detail::Requires<F, kShapes> = 0>
+    void polygon_outline(const BM_Point* points, int count) {
+        bm_polygon_outline(points, count);
+    }
+    template <unsigned F = Features, detail::Requires<F, kShapes> = 0>
+    void polyline(const BM_Point* points, int count, float thickness) {
+        bm_polyline(points, count, thickness);
+    }
+#endif
+
+#ifndef BM_CONFIG_NO_TEXT
+    template <unsigned F = Features, detail::Requires<F, kText> = 0>
+    void text(BM_Font* font, float x, float y, const char* utf8) {
+        bm_text(font, x, y, utf8);
+    }
+#endif
+
+#ifndef BM_CONFIG_NO_TILEMAPS
+    template <unsigned F = Features, detail::Requires<F, kTilemaps> = 0>
+    void tilemap(BM_Tilemap* map, float camera_x, float camera_y) {
+        bm_tilemap(map, camera_x, camera_y);
+    }
+#endif
+
+#ifndef BM_CONFIG_NO_PARTICLES
+    template <unsigned F = Features, detail::Requires<F, kParticles> = 0>
+    void particles(BM_ParticleEmitter* emitter) {
+        bm_particles(emitter);
+    }
+#endif
+
+private:
+    BM_Context* ctx_;
+};
+
+} // namespace bm
+
+#endif // BANGERMAN_HPP
@@ -0,0 +1,214 @@
+// ============================================================
+// bm_alloc_large_pages — huge-page / NUMA BM_Allocator
+// BangDev / Crayon playground
+// ------------------------------------------------------------
+// - Backs command blocks and frame arenas with 2 MiB pages, so
+//   frames of hundreds of MB need few TLB entries
+// - Linux: MAP_HUGETLB when hugetlbfs pages are reserved,
+//   otherwise 2 MiB-aligned mappings + madvise(MADV_HUGEPAGE)
+//   (transparent huge pages)
+// - Optional NUMA node per allocator (Linux mbind, Windows
+//   VirtualAllocExNuma); pages are preferred, not forced, there
+// - Windows: MEM_LARGE_PAGES when the process may lock pages
+// - Elsewhere: plain malloc
+// ============================================================
+//
+// Usage:
+//
+//   #include "bangerman.h"
+//   #include "extras/large-pages/bm_alloc_large_pages.h"
+//
+//   // In ONE .c file, additionally (on Linux, compile that file
+//   // with _GNU_SOURCE or _DEFAULT_SOURCE for MAP_ANONYMOUS):
+//   #define BM_ALLOC_LARGE_PAGES_IMPLEMENTATION
+//
+//   // One context per worker, its storage on the worker's node:
+//   BM_Allocator a   = bm_large_page_allocator(node);  // < 0: any node
+//   BM_Context*  ctx = bm_create_with_allocator(4 << 20, &a);
+//
+// A command block is then one whole large page (29127 commands),
+// so this only pays off for contexts that record large frames.
+//
+// ============================================================
+
+#ifndef BM_ALLOC_LARGE_PAGES_H
+#define BM_ALLOC_LARGE_PAGES_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BM_LARGE_PAGE_SIZE ((size_t)2 << 20)
+
+BM_Allocator bm_large_page_allocator(int numa_node);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // BM_ALLOC_LARGE_PAGES_H
+
+// ============================================================
+// IMPLEMENTATION
+// ============================================================
+
+#ifdef BM_ALLOC_LARGE_PAGES_IMPLEMENTATION
+#ifndef BM_ALLOC_LARGE_PAGES_IMPLEMENTATION_DONE
+#define BM_ALLOC_LARGE_PAGES_IMPLEMENTATION_DONE
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// The node travels in the allocator's user pointer, offset by one
+// so that "no node" is NULL.
+static int
+bm_lp__node(void* user)
+{
+    return (int)(intptr_t)user - 1;
+}
+
+static size_t
+bm_lp__round(size_t size)
+{
+    return (size + BM_LARGE_PAGE_SIZE - 1) & ~(BM_LARGE_PAGE_SIZE - 1);
+}
+
+#if defined(_WIN32)
+
+static void*
+bm_lp__alloc(size_t size, void* user)
+{
+    int    node  = bm_lp__node(user);
+    DWORD  pref  = node >= 0 ? (DWORD)node : NUMA_NO_PREFERRED_NODE;
+    SIZE_T large = GetLargePageMinimum();
+    void*  p     = NULL;
+
+    // Needs SeLockMemoryPrivilege; without it fall back to normal
+    // pages (still node-local).
+    if (large) {
+        SIZE_T rounded = (size + large - 1) & ~(large - 1);
+        p = VirtualAllocExNuma(GetCurrentProcess(), NULL, rounded,
+                               MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+                               PAGE_READWRITE, pref);
+    }
+    if (!p) {
+        p = VirtualAllocExNuma(GetCurrentProcess(), NULL, size,
+                               MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, pref);
+    }
+    return p;
+}
+
+static void
+bm_lp__free(void* ptr, size_t size, void* user)
+{
+    (void)size;
+    (void)user;
+    VirtualFree(ptr, 0, MEM_RELEASE);
+}
+
+#elif defined(__linux__)
+
+static void
+bm_lp__bind(void* p, size_t size, int node)
+{
+#ifdef SYS_mbind
+    // Raw syscall so there is no libnuma dependency. Preferred, so
+    // a full node spills over instead of failing the allocation.
+    unsigned long mask[16] = {0};
+    const int     bits     = (int)(8 * sizeof(unsigned long));
+    const int     mpolPreferred = 1;
+    if (node >= (int)(sizeof(mask) * 8)) return;
+    mask[node / bits] |= 1ul << (node % bits);
+    syscall(SYS_mbind, p, size, mpolPreferred, mask,
+            (unsigned long)(sizeof(mask) * 8 + 1), 0u);
+#else
+    (void)p;
+    (void)size;
+    (void)node;
+#endif
+}
+
+static void*
+bm_lp__alloc(size_t size, void* user)
+{
+    size = bm_lp__round(size);
+
+    void* p = MAP_FAILED;
+#ifdef MAP_HUGETLB
+    p = mmap(NULL, size, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+    if (p == MAP_FAILED) {
+        // No reserved huge pages: map 2 MiB-aligned so transparent
+        // huge pages can back every page, then trim the slack.
+        size_t span = size + BM_LARGE_PAGE_SIZE;
+        unsigned char* raw = (unsigned char*)mmap(NULL, span, PROT_READ | PROT_WRITE,
+                                                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == (unsigned char*)MAP_FAILED) return NULL;
+
+        uintptr_t aligned = ((uintptr_t)raw + BM_LARGE_PAGE_SIZE - 1) &
+                            ~(uintptr_t)(BM_LARGE_PAGE_SIZE - 1);
+        size_t head = (size_t)(aligned - (uintptr_t)raw);
+        size_t tail = span - head - size;
+        if (head) munmap(raw, head);
+        if (tail) munmap((unsigned char*)aligned + size, tail);
+        p = (void*)aligned;
+#ifdef MADV_HUGEPAGE
+        madvise(p, size, MADV_HUGEPAGE);
+#endif
+    }
+
+    // Before first touch, so the pages are placed by the policy.
+    int node = bm_lp__node(user);
+    if (node >= 0) bm_lp__bind(p, size, node);
+    return p;
+}
+
+static void
+bm_lp__free(void* ptr, size_t size, void* user)
+{
+    (void)user;
+    munmap(ptr, bm_lp__round(size));
+}
+
+#else
+
+static void*
+bm_lp__alloc(size_t size, void* user)
+{
+    (void)user;
+    return malloc(size);
+}
+
+static void
+bm_lp__free(void* ptr, size_t size, void* user)
+{
+    (void)size;
+    (void)user;
+    free(ptr);
+}
+
+#endif
+
+BM_Allocator
+bm_large_page_allocator(int numa_node)
+{
+    BM_Allocator a;
+    a.alloc       = bm_lp__alloc;
+    a.free        = bm_lp__free;
+    a.user        = (void*)(intptr_t)(numa_node >= 0 ? numa_node + 1 : 0);
+    a.granularity = BM_LARGE_PAGE_SIZE;
+    return a;
+}
+
+#endif // BM_ALLOC_LARGE_PAGES_IMPLEMENTATION_DONE
+#endif // BM_ALLOC_LARGE_PAGES_IMPLEMENTATION
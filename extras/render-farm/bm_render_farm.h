@@ -0,0 +1,448 @@
+// ============================================================
+// bm_render_farm — batch offline rendering on a thread pool
+// BangDev / Crayon playground
+// ------------------------------------------------------------
+// - Renders many independent, already recorded BM_Contexts with
+//   the CPU backend, one private BM_CPURenderer per worker
+// - Headless: no SDL, no windows, no GPU
+// - PPM (P6) and PNG (RGBA, uncompressed "stored" deflate)
+//   writers, usable on their own
+// ============================================================
+//
+// Usage:
+//
+//   #include "bangerman.h"
+//   #include "renderers/CPU/bm_renderer_CPU.c"
+//   #include "extras/render-farm/bm_render_farm.h"
+//
+//   // In ONE .c file, additionally (link with -lpthread on POSIX):
+//   #define BM_RENDER_FARM_IMPLEMENTATION
+//
+//   // Record each scene into its own context (bm_make_current,
+//   // bm_begin_frame ... bm_end_frame), then:
+//   BM_RenderJob jobs[N] = {0};
+//   jobs[i].ctx    = scenes[i];
+//   jobs[i].pixels = buffers[i];        // width * height uint32_t
+//   jobs[i].width  = 128;
+//   jobs[i].height = 72;
+//   jobs[i].path   = "thumb_0001.png";  // optional, .png or .ppm
+//   int ok = bm_render_farm(jobs, N, 0, &texturesAndOptions);
+//
+// A context may appear in only one job per batch and must not be
+// recorded into while the batch runs. Fonts, tilemaps and texture
+// pixels are only read, so scenes may share them.
+//
+// ============================================================
+
+#ifndef BM_RENDER_FARM_H
+#define BM_RENDER_FARM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    BM_Context* ctx;     // recorded frame
+    void*       pixels;  // caller-owned output, see BM_CPURenderer
+    int         width;
+    int         height;
+    int         pitch;   // in pixels; 0 means width
+    const char* path;    // written after rendering if non-NULL
+                         // (".png" -> PNG, anything else -> PPM;
+                         // ARGB8888 output only)
+    int         result;  // out: 1 rendered (and written), 0 failed
+} BM_RenderJob;
+
+// Renders `count` jobs on `threads` workers (0 = one per CPU; the
+// calling thread is one of them). `options` supplies texture
+// bindings and output settings (format, dither, indexed) shared by
+// every job; its pixels / size are ignored, NULL = defaults.
+// Returns the number of jobs that succeeded.
+int bm_render_farm(BM_RenderJob*         jobs,
+                   int                   count,
+                   int                   threads,
+                   const BM_CPURenderer* options);
+
+// Image writers for 0xAARRGGBB pixels; 1 on success.
+int bm_write_ppm(const char* path, const uint32_t* argb,
+                 int width, int height, int pitch);
+int bm_write_png(const char* path, const uint32_t* argb,
+                 int width, int height, int pitch);
+int bm_write_image(const char* path, const uint32_t* argb,  // by extension
+                   int width, int height, int pitch);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // BM_RENDER_FARM_H
+
+// ============================================================
+// IMPLEMENTATION
+// ============================================================
+
+#ifdef BM_RENDER_FARM_IMPLEMENTATION
+#ifndef BM_RENDER_FARM_IMPLEMENTATION_DONE
+#define BM_RENDER_FARM_IMPLEMENTATION_DONE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+// ------------------------------------------------------------
+// Image writers
+// ------------------------------------------------------------
+
+int
+bm_write_ppm(const char* path, const uint32_t* argb, int width, int height, int pitch)
+{
+    if (!path || !argb || width < 1 || height < 1) return 0;
+    if (pitch <= 0) pitch = width;
+
+    FILE* f = fopen(path, "wb");
+    if (!f) return 0;
+
+    unsigned char* row = (unsigned char*)malloc((size_t)width * 3);
+    int ok = row && fprintf(f, "P6\n%d %d\n255\n", width, height) > 0;
+    for (int y = 0; ok && y < height; ++y) {
+        const uint32_t* src = argb + (size_t)y * (size_t)pitch;
+        for (int x = 0; x < width; ++x) {
+            row[x * 3 + 0] = (unsigned char)(src[x] >> 16);
+            row[x * 3 + 1] = (unsigned char)(src[x] >> 8);
+            row[x * 3 + 2] = (unsigned char)(src[x]);
+        }
+        ok = fwrite(row, 3, (size_t)width, f) == (size_t)width;
+    }
+    free(row);
+    if (fclose(f) != 0) ok = 0;
+    return ok;
+}
+
+static void
+bm_farm__be32(unsigned char* p, uint32_t v)
+{
+    p[0] = (unsigned char)(v >> 24);
+    p[1] = (unsigned char)(v >> 16);
+    p[2] = (unsigned char)(v >> 8);
+    p[3] = (unsigned char)(v);
+}
+
+// CRC-32 (PNG chunks). The table is built per call: cheap next to
+// the image, and workers share no mutable state.
+static uint32_t
+bm_farm__crc(const uint32_t table[256], uint32_t crc, const unsigned char* p, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        crc = table[(crc ^ p[i]) & 0xFFu] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+static int
+bm_farm__chunk(FILE* f, const uint32_t table[256], const char* type,
+               const unsigned char* data, size_t size)
+{
+    unsigned char head[8];
+    unsigned char tail[4];
+    bm_farm__be32(head, (uint32_t)size);
+    memcpy(head + 4, type, 4);
+    uint32_t crc = bm_farm__crc(table, 0xFFFFFFFFu, head + 4, 4);
+    crc = bm_farm__crc(table, crc, data, size) ^ 0xFFFFFFFFu;
+    bm_farm__be32(tail, crc);
+    return fwrite(head, 1, 8, f) == 8 &&
+           (size == 0 || fwrite(data, 1, size, f) == size) &&
+           fwrite(tail, 1, 4, f) == 4;
+}
+
+int
+bm_write_png(const char* path, const uint32_t* argb, int width, int height, int pitch)
+{
+    if (!path || !argb || width < 1 || height < 1) return 0;
+    if (pitch <= 0) pitch = width;
+
+    // Scanlines (filter byte 0 + RGBA) wrapped in a zlib stream of
+    // stored deflate blocks: no compression, trivially fast.
+    size_t rowBytes = 1 + (size_t)width * 4;
+    size_t raw      = rowBytes * (size_t)height;
+    size_t blocks   = (raw + 65534) / 65535;
+    size_t zsize    = 2 + raw + blocks * 5 + 4;
+    if (rowBytes / 4 < (size_t)width || raw / rowBytes != (size_t)height) return 0;
+
+    unsigned char* z = (unsigned char*)malloc(zsize);
+    unsigned char* line = (unsigned char*)malloc(rowBytes);
+    if (!z || !line) {
+        free(z);
+        free(line);
+        return 0;
+    }
+
+    uint32_t s1 = 1, s2 = 0;  // Adler-32 of the raw scanlines
+    size_t   o  = 0;
+    size_t   blockLeft = 0;
+    size_t   rawLeft   = raw;
+    z[o++] = 0x78;  // deflate, 32K window
+    z[o++] = 0x01;  // no preset dictionary, fastest; (0x7801 % 31 == 0)
+    for (int y = 0; y < height; ++y) {
+        const uint32_t* src = argb + (size_t)y * (size_t)pitch;
+        line[0] = 0;
+        for (int x = 0; x < width; ++x) {
+            unsigned char* d = &line[1 + x * 4];
+            d[0] = (unsigned char)(src[x] >> 16);
+            d[1] = (unsigned char)(src[x] >> 8);
+            d[2] = (unsigned char)(src[x]);
+            d[3] = (unsigned char)(src[x] >> 24);
+        }
+        for (size_t i = 0; i < rowBytes; ) {
+            if (blockLeft == 0) {
+                blockLeft = rawLeft < 65535 ? rawLeft : 65535;
+                z[o++] = (unsigned char)(rawLeft == blockLeft);  // BFINAL, BTYPE 00
+                z[o++] = (unsigned char)(blockLeft);
+                z[o++] = (unsigned char)(blockLeft >> 8);
+                z[o++] = (unsigned char)(~blockLeft);
+                z[o++] = (unsigned char)(~blockLeft >> 8);
+            }
+            size_t n = rowBytes - i < blockLeft ? rowBytes - i : blockLeft;
+            memcpy(z + o, line + i, n);
+            for (size_t k = 0; k < n; ++k) {
+                s1 += line[i + k];
+                s2 += s1;
+                if ((k & 4095) == 4095) {  // well inside the 5552 bound
+                    s1 %= 65521u;
+                    s2 %= 65521u;
+                }
+            }
+            s1 %= 65521u;
+            s2 %= 65521u;
+            o         += n;
+            i         += n;
+            blockLeft -= n;
+            rawLeft   -= n;
+        }
+    }
+    bm_farm__be32(z + o, (s2 << 16) | s1);
+    o += 4;
+    free(line);
+
+    uint32_t table[256];
+    for (uint32_t n = 0; n < 256; ++n) {
+        uint32_t c = n;
+        for (int k = 0; k < 8; ++k) c = (c & 1u) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        table[n] = c;
+    }
+
+    unsigned char ihdr[13];
+    bm_farm__be32(ihdr, (uint32_t)width);
+    bm_farm__be32(ihdr + 4, (uint32_t)height);
+    ihdr[8]  = 8;  // bits per channel
+    ihdr[9]  = 6;  // RGBA
+    ihdr[10] = 0;  // deflate
+    ihdr[11] = 0;  // adaptive filtering (all rows use "none")
+    ihdr[12] = 0;  // not interlaced
+
+    static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    FILE* f  = fopen(path, "wb");
+    int   ok = f != NULL;
+    ok = ok && fwrite(signature, 1, 8, f) == 8;
+    ok = ok && bm_farm__chunk(f, table, "IHDR", ihdr, sizeof(ihdr));
+    // Chunk lengths are 31-bit; split big images over several IDATs.
+    for (size_t done = 0; ok && done < o; ) {
+        size_t n = o - done < ((size_t)1 << 30) ? o - done : ((size_t)1 << 30);
+        ok = bm_farm__chunk(f, table, "IDAT", z + done, n);
+        done += n;
+    }
+    ok = ok && bm_farm__chunk(f, table, "IEND", NULL, 0);
+    if (f && fclose(f) != 0) ok = 0;
+    free(z);
+    return ok;
+}
+
+int
+bm_write_image(const char* path, const uint32_t* argb, int width, int height, int pitch)
+{
+    if (!path) return 0;
+    size_t n = strlen(path);
+    if (n >= 4 && (!strcmp(path + n - 4, ".png") || !strcmp(path + n - 4, ".PNG"))) {
+        return bm_write_png(path, argb, width, height, pitch);
+    }
+    return bm_write_ppm(path, argb, width, height, pitch);
+}
+
+// ------------------------------------------------------------
+// Thread pool
+// ------------------------------------------------------------
+
+typedef struct {
+    BM_RenderJob*         jobs;
+    int                   count;
+    int                   next;       // next unclaimed job, under lock
+    int                   succeeded;  // under lock
+    const BM_CPURenderer* options;
+#ifdef _WIN32
+    SRWLOCK               lock;
+#else
+    pthread_mutex_t       lock;
+#endif
+} BM_Farm;
+
+#ifdef _WIN32
+#define BM_FARM__LOCK(f)   AcquireSRWLockExclusive(&(f)->lock)
+#define BM_FARM__UNLOCK(f) ReleaseSRWLockExclusive(&(f)->lock)
+#else
+#define BM_FARM__LOCK(f)   pthread_mutex_lock(&(f)->lock)
+#define BM_FARM__UNLOCK(f) pthread_mutex_unlock(&(f)->lock)
+#endif
+
+static int
+bm_farm__render(BM_CPURenderer* r, const BM_CPURenderer* options, BM_RenderJob* job)
+{
+    if (!job->ctx || !job->pixels || job->width < 1 || job->height < 1) return 0;
+
+    r->pixels = job->pixels;
+    r->width  = job->width;
+    r->height = job->height;
+    r->pitch  = job->pitch;
+    BM_CPU_Render(r, job->ctx);
+
+    if (!job->path) return 1;
+    if (options && options->format != BM_CPU_FORMAT_ARGB8888) return 0;
+    return bm_write_image(job->path, (const uint32_t*)job->pixels,
+                          job->width, job->height, job->pitch);
+}
+
+// Each worker claims jobs one at a time (scenes vary a lot in cost)
+// and renders with a private renderer, so canvases and scratch
+// buffers are reused across its jobs and never shared.
+static void
+bm_farm__work(BM_Farm* farm)
+{
+    BM_CPURenderer r;
+    memset(&r, 0, sizeof(r));
+    if (farm->options) {
+        r.format       = farm->options->format;
+        r.dither       = farm->options->dither;
+        r.indexed      = farm->options->indexed;
+        r.textures     = farm->options->textures;  // borrowed, read-only
+        r.textureCount = farm->options->textureCount;
+    }
+
+    int succeeded = 0;
+    for (;;) {
+        BM_FARM__LOCK(farm);
+        int i = farm->next < farm->count ? farm->next++ : -1;
+        BM_FARM__UNLOCK(farm);
+        if (i < 0) break;
+
+        BM_PROFILE_BEGIN("bm_farm_job");
+        BM_RenderJob* job = &farm->jobs[i];
+        job->result = bm_farm__render(&r, farm->options, job);
+        succeeded += job->result;
+        BM_PROFILE_END("bm_farm_job");
+    }
+
+    BM_FARM__LOCK(farm);
+    farm->succeeded += succeeded;
+    BM_FARM__UNLOCK(farm);
+
+    r.textures     = NULL;  // not ours to free
+    r.textureCount = 0;
+    BM_CPU_Destroy(&r);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI
+bm_farm__thread(LPVOID arg)
+{
+    bm_farm__work((BM_Farm*)arg);
+    return 0;
+}
+#else
+static void*
+bm_farm__thread(void* arg)
+{
+    bm_farm__work((BM_Farm*)arg);
+    return NULL;
+}
+#endif
+
+static int
+bm_farm__cpu_count(void)
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#else
+    return 1;
+#endif
+}
+
+int
+bm_render_farm(BM_RenderJob*         jobs,
+               int                   count,
+               int                   threads,
+               const BM_CPURenderer* options)
+{
+    if (!jobs || count <= 0) return 0;
+    if (threads <= 0) threads = bm_farm__cpu_count();
+    if (threads > count) threads = count;
+
+    BM_Farm farm;
+    memset(&farm, 0, sizeof(farm));
+    farm.jobs    = jobs;
+    farm.count   = count;
+    farm.options = options;
+#ifdef _WIN32
+    InitializeSRWLock(&farm.lock);
+#else
+    pthread_mutex_init(&farm.lock, NULL);
+#endif
+
+    BM_PROFILE_BEGIN("bm_render_farm");
+    // The caller is worker 0; if a thread fails to start, the rest
+    // simply take its share.
+#ifdef _WIN32
+    HANDLE* handles = threads > 1
+                    ? (HANDLE*)calloc((size_t)threads - 1, sizeof(HANDLE)) : NULL;
+    for (int t = 0; handles && t < threads - 1; ++t) {
+        handles[t] = CreateThread(NULL, 0, bm_farm__thread, &farm, 0, NULL);
+    }
+    bm_farm__work(&farm);
+    for (int t = 0; handles && t < threads - 1; ++t) {
+        if (!handles[t]) continue;
+        WaitForSingleObject(handles[t], INFINITE);
+        CloseHandle(handles[t]);
+    }
+    free(handles);
+#else
+    pthread_t* ids = threads > 1
+                   ? (pthread_t*)calloc((size_t)threads - 1, sizeof(pthread_t)) : NULL;
+    char* live = threads > 1 ? (char*)calloc((size_t)threads - 1, 1) : NULL;
+    for (int t = 0; ids && live && t < threads - 1; ++t) {
+        live[t] = pthread_create(&ids[t], NULL, bm_farm__thread, &farm) == 0;
+    }
+    bm_farm__work(&farm);
+    for (int t = 0; ids && live && t < threads - 1; ++t) {
+        if (live[t]) pthread_join(ids[t], NULL);
+    }
+    free(ids);
+    free(live);
+    pthread_mutex_destroy(&farm.lock);
+#endif
+    BM_PROFILE_END("bm_render_farm");
+
+    return farm.succeeded;
+}
+
+#endif // BM_RENDER_FARM_IMPLEMENTATION_DONE
+#endif // BM_RENDER_FARM_IMPLEMENTATION
@@ -0,0 +1,1031 @@
+// ============================================================
+// BM_CPU_Render — software rasterizer backend for BangerMan
+// BangDev / Crayon playground
+// ------------------------------------------------------------
+// - Consumes BM_Command buffer, no GPU or windowing needed
+// - Rasterizes at logical resolution into an internal canvas
+// - Integer-upscales + centers the canvas into a caller-owned
+//   ARGB8888 buffer (same layout as SDL_PIXELFORMAT_ARGB8888)
+// - Optional 8bpp indexed canvas, expanded through the frame's
+//   palette during the upscale
+// - Optional RGB565 / RGB444 output with Bayer ordered dither
+// ============================================================
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "bangerman.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(__SSSE3__) || defined(__AVX__)
+#define BM_CPU__SSSE3 1
+#include <tmmintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BM_CPU__SSE2 1
+#include <emmintrin.h>
+#endif
+
+// Output pixel formats. 16-bit formats halve framebuffer bandwidth;
+// RGB444 is 0x0RGB in a 16-bit word.
+typedef enum {
+    BM_CPU_FORMAT_ARGB8888 = 0,
+    BM_CPU_FORMAT_RGB565,
+    BM_CPU_FORMAT_RGB444,
+} BM_CPUFormat;
+
+// Caller-owned texture pixels: 0xAARRGGBB, or 8-bit palette indices
+// (index 0 transparent) for textures bound with
+// BM_CPU_SetTextureIndexed.
+typedef struct {
+    const uint32_t *pixels;
+    const uint8_t  *indices;
+    int             width;
+    int             height;
+} BM_CPUTexture;
+
+typedef struct {
+    // Output target (caller-owned): uint32_t 0xAARRGGBB pixels, or
+    // uint16_t for the 16-bit formats
+    void        *pixels;
+    int          width;
+    int          height;
+    int          pitch;     // in pixels; 0 means width
+    BM_CPUFormat format;
+    int          dither;    // 4x4 Bayer ordered dither (16-bit formats)
+    uint32_t    *outRow;    // owned, one ARGB output row (16-bit formats)
+    int          outRowCapacity;
+
+    // Internal logical-resolution canvas (owned, reused across frames)
+    uint32_t *canvas;
+    int       canvasW;
+    int       canvasH;
+
+    // Indexed mode: when set and the frame has a palette, commands
+    // rasterize 8-bit palette indices (a quarter of the bandwidth)
+    // and the upscale expands them. Alpha is 1-bit (>= 0.5 draws),
+    // RGB colors snap to the nearest entry, and only indexed
+    // textures are drawn.
+    int       indexed;
+    uint8_t  *canvas8;      // owned, canvasW * canvasH
+    uint32_t *rowScratch;   // owned, one expanded canvas row
+    uint32_t  palette[BM_PALETTE_SIZE];  // frame palette, zero-padded
+    int       paletteSize;  // entries in this frame's palette
+    int       drawIndexed;  // this frame rasterizes into canvas8
+
+    // BM_TextureId -> texture, see BM_CPU_SetTexture
+    BM_CPUTexture *textures;
+    int            textureCount;
+
+    // Polyline edge rows scratch, see bm_polyline_tessellate
+    BM_Point      *rows;
+    int            rowCapacity;   // in points
+
+#ifdef BM_ENABLE_STATS
+    BM_BackendStats stats;  // last replay
+#endif
+} BM_CPURenderer;
+
+// ------------------------------------------------------------
+// Internal helpers
+// ------------------------------------------------------------
+
+static uint32_t
+bm_cpu__pack(BM_Color c)
+{
+    float ch[4] = { c.a, c.r, c.g, c.b };
+    uint32_t out = 0;
+    for (int i = 0; i < 4; ++i) {
+        float v = ch[i];
+        if (v < 0.0f) v = 0.0f;
+        if (v > 1.0f) v = 1.0f;
+        out = (out << 8) | (uint32_t)(v * 255.0f);
+    }
+    return out;
+}
+
+// Source-over blend of a packed color onto a packed pixel.
+static inline uint32_t
+bm_cpu__blend(uint32_t dst, uint32_t src)
+{
+    uint32_t a = src >> 24;
+    if (a == 255) return src;
+    if (a == 0)   return dst;
+
+    uint32_t ia = 255 - a;
+    uint32_t rb = ((src & 0x00FF00FFu) * a + (dst & 0x00FF00FFu) * ia);
+    uint32_t g  = ((src & 0x0000FF00u) * a + (dst & 0x0000FF00u) * ia);
+    uint32_t da = (dst >> 24);
+    uint32_t oa = a + ((da * ia) / 255);
+
+    rb = ((rb + 0x00800080u + ((rb >> 8) & 0x00FF00FFu)) >> 8) & 0x00FF00FFu;
+    g  = ((g  + 0x00008000u + ((g  >> 8) & 0x0000FF00u)) >> 8) & 0x0000FF00u;
+    return (oa << 24) | rb | g;
+}
+
+static void
+bm_cpu__span(BM_CPURenderer *r, int x0, int x1, int y, uint32_t c)
+{
+    if (y < 0 || y >= r->canvasH) return;
+    if (x0 < 0) x0 = 0;
+    if (x1 > r->canvasW) x1 = r->canvasW;
+    if (x0 >= x1) return;
+
+    if (r->drawIndexed) {
+        if (c >> 24) {
+            memset(r->canvas8 + (size_t)y * (size_t)r->canvasW + x0,
+                   (int)(c & 0xFFu), (size_t)(x1 - x0));
+        }
+        return;
+    }
+
+    uint32_t *row = r->canvas + (size_t)y * (size_t)r->canvasW;
+    if ((c >> 24) == 255) {
+        for (int x = x0; x < x1; ++x) row[x] = c;
+    } else {
+        for (int x = x0; x < x1; ++x) row[x] = bm_cpu__blend(row[x], c);
+    }
+}
+
+static inline void
+bm_cpu__plot(BM_CPURenderer *r, int x, int y, uint32_t c)
+{
+    if ((unsigned)x >= (unsigned)r->canvasW ||
+        (unsigned)y >= (unsigned)r->canvasH) return;
+    if (r->drawIndexed) {
+        if (c >> 24) r->canvas8[(size_t)y * (size_t)r->canvasW + x] = (uint8_t)c;
+        return;
+    }
+    uint32_t *p = r->canvas + (size_t)y * (size_t)r->canvasW + x;
+    *p = bm_cpu__blend(*p, c);
+}
+
+// Pixel centers inside [v, v + len) are covered.
+static inline int
+bm_cpu__snap(float v)
+{
+    return (int)floorf(v + 0.5f);
+}
+
+static void
+bm_cpu__rect_fill(BM_CPURenderer *r, const BM_Command *cmd, uint32_t c)
+{
+    int x0 = bm_cpu__snap(cmd->x);
+    int y0 = bm_cpu__snap(cmd->y);
+    int x1 = bm_cpu__snap(cmd->x + cmd->w);
+    int y1 = bm_cpu__snap(cmd->y + cmd->h);
+    if (y0 < 0) y0 = 0;
+    if (y1 > r->canvasH) y1 = r->canvasH;
+    for (int y = y0; y < y1; ++y) {
+        bm_cpu__span(r, x0, x1, y, c);
+    }
+}
+
+static void
+bm_cpu__rect_outline(BM_CPURenderer *r, const BM_Command *cmd, uint32_t c)
+{
+    int x0 = bm_cpu__snap(cmd->x);
+    int y0 = bm_cpu__snap(cmd->y);
+    int x1 = bm_cpu__snap(cmd->x + cmd->w);
+    int y1 = bm_cpu__snap(cmd->y + cmd->h);
+    if (x0 >= x1 || y0 >= y1) return;
+
+    bm_cpu__span(r, x0, x1, y0, c);
+    if (y1 - 1 > y0) bm_cpu__span(r, x0, x1, y1 - 1, c);
+    for (int y = y0 + 1; y < y1 - 1; ++y) {
+        bm_cpu__plot(r, x0, y, c);
+        if (x1 - 1 > x0) bm_cpu__plot(r, x1 - 1, y, c);
+    }
+}
+
+static void
+bm_cpu__segment(BM_CPURenderer *r, float fx0, float fy0, float fx1, float fy1,
+                uint32_t c)
+{
+    // Bresenham between the pixels containing each endpoint.
+    int x0 = (int)floorf(fx0);
+    int y0 = (int)floorf(fy0);
+    int x1 = (int)floorf(fx1);
+    int y1 = (int)floorf(fy1);
+
+    int dx =  abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+    int dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+    int err = dx + dy;
+    for (;;) {
+        bm_cpu__plot(r, x0, y0, c);
+        if (x0 == x1 && y0 == y1) break;
+        int e2 = 2 * err;
+        if (e2 >= dy) { err += dy; x0 += sx; }
+        if (e2 <= dx) { err += dx; y0 += sy; }
+    }
+}
+
+static void
+bm_cpu__line(BM_CPURenderer *r, const BM_Command *cmd, uint32_t c)
+{
+    bm_cpu__segment(r, cmd->x, cmd->y, cmd->x2, cmd->y2, c);
+}
+
+#ifndef BM_CONFIG_NO_SHAPES
+// Horizontal extent [*x0, *x1) of an ellipse on the row whose pixel
+// centers sit at yc; 0 if the row misses it.
+static inline int
+bm_cpu__ellipse_row(float cx, float cy, float rx, float ry, float yc,
+                    int *x0, int *x1)
+{
+    if (rx <= 0.0f || ry <= 0.0f) return 0;
+    float dy = (yc - cy) / ry;
+    float k  = 1.0f - dy * dy;
+    if (k <= 0.0f) return 0;
+    float half = rx * sqrtf(k);
+    *x0 = bm_cpu__snap(cx - half);
+    *x1 = bm_cpu__snap(cx + half);
+    return *x0 < *x1;
+}
+
+// Scanline ellipse: one span per row (two for outlines, the ring
+// between the ellipse and one shrunk by a pixel).
+static void
+bm_cpu__ellipse(BM_CPURenderer *r, const BM_Command *cmd, int outline,
+                uint32_t c)
+{
+    float cx = cmd->x, cy = cmd->y, rx = cmd->w, ry = cmd->h;
+    int y0 = bm_cpu__snap(cy - ry);
+    int y1 = bm_cpu__snap(cy + ry);
+    if (y0 < 0) y0 = 0;
+    if (y1 > r->canvasH) y1 = r->canvasH;
+
+    for (int y = y0; y < y1; ++y) {
+        float yc = (float)y + 0.5f;
+        int ox0, ox1, ix0, ix1;
+        if (!bm_cpu__ellipse_row(cx, cy, rx, ry, yc, &ox0, &ox1)) continue;
+        if (!outline ||
+            !bm_cpu__ellipse_row(cx, cy, rx - 1.0f, ry - 1.0f, yc, &ix0, &ix1)) {
+            bm_cpu__span(r, ox0, ox1, y, c);
+            continue;
+        }
+        if (ix0 <= ox0) ix0 = ox0 + 1;
+        if (ix1 >= ox1) ix1 = ox1 - 1;
+        if (ix0 >= ix1) {
+            bm_cpu__span(r, ox0, ox1, y, c);
+        } else {
+            bm_cpu__span(r, ox0, ix0, y, c);
+            bm_cpu__span(r, ix1, ox1, y, c);
+        }
+    }
+}
+
+// Scanline convex polygon: each row is one span between the
+// leftmost and rightmost edge crossing at the pixel centers.
+static void
+bm_cpu__polygon_fill(BM_CPURenderer *r, const BM_Point *p, int n, uint32_t c)
+{
+    float minY = p[0].y, maxY = p[0].y;
+    for (int i = 1; i < n; ++i) {
+        if (p[i].y < minY) minY = p[i].y;
+        if (p[i].y > maxY) maxY = p[i].y;
+    }
+    int y0 = bm_cpu__snap(minY);
+    int y1 = bm_cpu__snap(maxY);
+    if (y0 < 0) y0 = 0;
+    if (y1 > r->canvasH) y1 = r->canvasH;
+
+    for (int y = y0; y < y1; ++y) {
+        float yc = (float)y + 0.5f;
+        float xl =  3.0e38f;
+        float xr = -3.0e38f;
+        for (int i = 0, j = n - 1; i < n; j = i++) {
+            float ay = p[j].y, by = p[i].y;
+            if ((ay < yc) == (by < yc)) continue;  // edge misses row
+            float x = p[j].x + (yc - ay) * (p[i].x - p[j].x) / (by - ay);
+            if (x < xl) xl = x;
+            if (x > xr) xr = x;
+        }
+        if (xl < xr) {
+            bm_cpu__span(r, bm_cpu__snap(xl), bm_cpu__snap(xr), y, c);
+        }
+    }
+}
+#endif // BM_CONFIG_NO_SHAPES
+
+// Multiplies a texel by the command color (per channel, /255).
+static inline uint32_t
+bm_cpu__modulate(uint32_t t, uint32_t c)
+{
+    if (c == 0xFFFFFFFFu) return t;
+    uint32_t out = 0;
+    for (int sh = 0; sh < 32; sh += 8) {
+        uint32_t x = ((t >> sh) & 0xFFu) * ((c >> sh) & 0xFFu) + 128u;
+        out |= (((x + (x >> 8)) >> 8) & 0xFFu) << sh;
+    }
+    return out;
+}
+
+// Nearest-neighbour textured quad (sprites, glyphs).
+static void
+bm_cpu__blit(BM_CPURenderer *r, const BM_CPUTexture *tex,
+             float x, float y, float w, float h,
+             float u0, float v0, float u1, float v1,
+             uint32_t c)
+{
+    int x0 = bm_cpu__snap(x);
+    int y0 = bm_cpu__snap(y);
+    int x1 = bm_cpu__snap(x + w);
+    int y1 = bm_cpu__snap(y + h);
+    if (x0 >= x1 || y0 >= y1) return;
+    if (r->drawIndexed && !(c >> 24)) return;
+
+    // Texel step per destination pixel, sampled at pixel centers.
+    float du = (u1 - u0) * (float)tex->width  / (float)(x1 - x0);
+    float dv = (v1 - v0) * (float)tex->height / (float)(y1 - y0);
+    float su = u0 * (float)tex->width  + du * 0.5f;
+    float sv = v0 * (float)tex->height + dv * 0.5f;
+
+    int cx0 = x0 < 0 ? 0 : x0;
+    int cy0 = y0 < 0 ? 0 : y0;
+    int cx1 = x1 > r->canvasW ? r->canvasW : x1;
+    int cy1 = y1 > r->canvasH ? r->canvasH : y1;
+
+    for (int py = cy0; py < cy1; ++py) {
+        int ty = (int)(sv + dv * (float)(py - y0));
+        if (ty < 0) ty = 0;
+        if (ty >= tex->height) ty = tex->height - 1;
+        size_t srcOff = (size_t)ty * (size_t)tex->width;
+        size_t dstOff = (size_t)py * (size_t)r->canvasW;
+
+        if (r->drawIndexed) {
+            // Index copy; the command color only gates visibility.
+            const uint8_t *srcRow = tex->indices + srcOff;
+            uint8_t       *dstRow = r->canvas8 + dstOff;
+            for (int px = cx0; px < cx1; ++px) {
+                int tx = (int)(su + du * (float)(px - x0));
+                if (tx < 0) tx = 0;
+                if (tx >= tex->width) tx = tex->width - 1;
+                if (srcRow[tx]) dstRow[px] = srcRow[tx];
+            }
+        } else if (!tex->pixels) {
+            // Indexed texture on an RGB canvas: through the palette.
+            const uint8_t *srcRow = tex->indices + srcOff;
+            uint32_t      *dstRow = r->canvas + dstOff;
+            for (int px = cx0; px < cx1; ++px) {
+                int tx = (int)(su + du * (float)(px - x0));
+                if (tx < 0) tx = 0;
+                if (tx >= tex->width) tx = tex->width - 1;
+                if (!srcRow[tx]) continue;
+                dstRow[px] = bm_cpu__blend(dstRow[px],
+                                           bm_cpu__modulate(r->palette[srcRow[tx]], c));
+            }
+        } else {
+            const uint32_t *srcRow = tex->pixels + srcOff;
+            uint32_t       *dstRow = r->canvas + dstOff;
+            for (int px = cx0; px < cx1; ++px) {
+                int tx = (int)(su + du * (float)(px - x0));
+                if (tx < 0) tx = 0;
+                if (tx >= tex->width) tx = tex->width - 1;
+                dstRow[px] = bm_cpu__blend(dstRow[px],
+                                           bm_cpu__modulate(srcRow[tx], c));
+            }
+        }
+    }
+}
+
+#ifndef BM_CONFIG_NO_SHAPES
+static int
+bm_cpu__reserve_rows(BM_CPURenderer *r, int points)
+{
+    if (points <= r->rowCapacity) return 1;
+
+    int newCap = r->rowCapacity ? r->rowCapacity * 2 : 256;
+    if (newCap < points) newCap = points;
+
+    BM_Point *rows = (BM_Point *)realloc(r->rows, (size_t)newCap * sizeof(BM_Point));
+    if (!rows) return 0;
+    r->rows        = rows;
+    r->rowCapacity = newCap;
+    return 1;
+}
+#endif
+
+static const BM_CPUTexture *
+bm_cpu__texture(const BM_CPURenderer *r, BM_TextureId id)
+{
+    if (id < 0 || id >= r->textureCount) return NULL;
+    const BM_CPUTexture *t = &r->textures[id];
+    if (r->drawIndexed) return t->indices ? t : NULL;
+    return (t->pixels || t->indices) ? t : NULL;
+}
+
+// Packed color for the indexed canvas: index in the low byte, 0xFF
+// in the top byte when visible. RGB colors take the nearest entry.
+static uint32_t
+bm_cpu__pack_index(const BM_CPURenderer *r, int paletteSize, BM_Color c)
+{
+    if (bm_color_is_index(c)) return 0xFF000000u | ((c.index - 1u) & 0xFFu);
+    if (c.a < 0.5f) return 0;
+
+    uint32_t want = bm_cpu__pack(c);
+    int      best = 0;
+    long     bestDist = -1;
+    for (int i = 0; i < paletteSize; ++i) {
+        long dr = (long)((want >> 16) & 0xFF) - (long)((r->palette[i] >> 16) & 0xFF);
+        long dg = (long)((want >>  8) & 0xFF) - (long)((r->palette[i] >>  8) & 0xFF);
+        long db = (long)( want        & 0xFF) - (long)( r->palette[i]        & 0xFF);
+        long d  = dr * dr + dg * dg + db * db;
+        if (bestDist < 0 || d < bestDist) {
+            bestDist = d;
+            best     = i;
+        }
+    }
+    return 0xFF000000u | (uint32_t)best;
+}
+
+// Palette expansion of one canvas row. Palettes of up to 16 entries
+// (the usual retro case) use SSSE3: pshufb looks up 16 pixels per
+// byte plane. Larger ones take 8 lookups per AVX2 gather, scalar
+// elsewhere (pshufb only indexes 16-byte tables, so 256 entries
+// would take 16 shuffles + blends per vector).
+static void
+bm_cpu__expand_row(uint32_t *dst, const uint8_t *src, int n,
+                   const uint32_t *palette, int paletteSize)
+{
+    int i = 0;
+#if defined(BM_CPU__SSSE3)
+    if (paletteSize <= 16) {
+        // Transpose entries 0..15 into B, G, R and A byte tables.
+        const __m128i planar = _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13,
+                                             2, 6, 10, 14, 3, 7, 11, 15);
+        const __m128i *pal = (const __m128i *)palette;
+        __m128i q0  = _mm_shuffle_epi8(_mm_loadu_si128(pal + 0), planar);
+        __m128i q1  = _mm_shuffle_epi8(_mm_loadu_si128(pal + 1), planar);
+        __m128i q2  = _mm_shuffle_epi8(_mm_loadu_si128(pal + 2), planar);
+        __m128i q3  = _mm_shuffle_epi8(_mm_loadu_si128(pal + 3), planar);
+        __m128i bg0 = _mm_unpacklo_epi32(q0, q1);  // B0-7, G0-7
+        __m128i ra0 = _mm_unpackhi_epi32(q0, q1);  // R0-7, A0-7
+        __m128i bg1 = _mm_unpacklo_epi32(q2, q3);  // B8-15, G8-15
+        __m128i ra1 = _mm_unpackhi_epi32(q2, q3);  // R8-15, A8-15
+        __m128i tb  = _mm_unpacklo_epi64(bg0, bg1);
+        __m128i tg  = _mm_unpackhi_epi64(bg0, bg1);
+        __m128i tr  = _mm_unpacklo_epi64(ra0, ra1);
+        __m128i ta  = _mm_unpackhi_epi64(ra0, ra1);
+
+        // Indices >= 16 saturate into the high bit, for which pshufb
+        // yields 0: the palette's zero padding.
+        const __m128i bias = _mm_set1_epi8(0x70);
+        for (; i + 16 <= n; i += 16) {
+            __m128i idx = _mm_adds_epu8(_mm_loadu_si128((const __m128i *)(src + i)), bias);
+            __m128i b   = _mm_shuffle_epi8(tb, idx);
+            __m128i g   = _mm_shuffle_epi8(tg, idx);
+            __m128i r   = _mm_shuffle_epi8(tr, idx);
+            __m128i a   = _mm_shuffle_epi8(ta, idx);
+            __m128i gb0 = _mm_unpacklo_epi8(b, g);
+            __m128i gb1 = _mm_unpackhi_epi8(b, g);
+            __m128i ar0 = _mm_unpacklo_epi8(r, a);
+            __m128i ar1 = _mm_unpackhi_epi8(r, a);
+            _mm_storeu_si128((__m128i *)(dst + i +  0), _mm_unpacklo_epi16(gb0, ar0));
+            _mm_storeu_si128((__m128i *)(dst + i +  4), _mm_unpackhi_epi16(gb0, ar0));
+            _mm_storeu_si128((__m128i *)(dst + i +  8), _mm_unpacklo_epi16(gb1, ar1));
+            _mm_storeu_si128((__m128i *)(dst + i + 12), _mm_unpackhi_epi16(gb1, ar1));
+        }
+    }
+#else
+    (void)paletteSize;
+#endif
+#if defined(__AVX2__)
+    for (; i + 8 <= n; i += 8) {
+        __m128i bytes = _mm_loadl_epi64((const __m128i *)(src + i));
+        __m256i idx   = _mm256_cvtepu8_epi32(bytes);
+        __m256i px    = _mm256_i32gather_epi32((const int *)palette, idx, 4);
+        _mm256_storeu_si256((__m256i *)(dst + i), px);
+    }
+#endif
+    for (; i + 4 <= n; i += 4) {
+        dst[i + 0] = palette[src[i + 0]];
+        dst[i + 1] = palette[src[i + 1]];
+        dst[i + 2] = palette[src[i + 2]];
+        dst[i + 3] = palette[src[i + 3]];
+    }
+    for (; i < n; ++i) dst[i] = palette[src[i]];
+}
+
+static int
+bm_cpu__ensure_canvas(BM_CPURenderer *r, int w, int h)
+{
+    if (w < 1) w = 1;
+    if (h < 1) h = 1;
+    int want8 = r->drawIndexed;
+    if (r->canvas && r->canvasW == w && r->canvasH == h &&
+        (!want8 || r->canvas8)) return 1;
+
+    uint32_t *buf = (uint32_t*)realloc(r->canvas,
+                                       (size_t)w * (size_t)h * sizeof(uint32_t));
+    if (!buf) return 0;
+    r->canvas = buf;
+
+    if (want8 || r->canvas8) {
+        uint8_t  *buf8 = (uint8_t *)realloc(r->canvas8, (size_t)w * (size_t)h);
+        uint32_t *row  = (uint32_t *)realloc(r->rowScratch, (size_t)w * sizeof(uint32_t));
+        if (buf8) r->canvas8 = buf8;
+        if (row)  r->rowScratch = row;
+        if (!buf8 || !row) return 0;
+    }
+    r->canvasW = w;
+    r->canvasH = h;
+    return 1;
+}
+
+// One upscaled ARGB output row from one canvas row (already in
+// ARGB), letterbox = clear.
+static void
+bm_cpu__scale_row(uint32_t *dst, int width, const uint32_t *src,
+                  int offX, int outW, int intScale, uint32_t clear)
+{
+    int x = 0;
+    for (; x < width && x < offX; ++x) dst[x] = clear;
+    while (x < width && x - offX < outW) {
+        int      s   = (x - offX) / intScale;
+        int      end = offX + (s + 1) * intScale;
+        uint32_t v   = src[s];
+        if (end > width) end = width;
+        for (; x < end; ++x) dst[x] = v;
+    }
+    for (; x < width; ++x) dst[x] = clear;
+}
+
+// 4x4 Bayer thresholds, 0..15.
+static const uint8_t bm_cpu__bayer[4][4] = {
+    {  0,  8,  2, 10 },
+    { 12,  4, 14,  6 },
+    {  3, 11,  1,  9 },
+    { 15,  7, 13,  5 },
+};
+
+// Per-byte dither bias for 4 consecutive pixels (x % 4 == 0..3) of
+// output row y, in memory order (B, G, R, A per pixel): a fraction
+// of one quantization step of each channel.
+static void
+bm_cpu__dither_bias(BM_CPUFormat format, int y, uint8_t out[16])
+{
+    int shiftR = format == BM_CPU_FORMAT_RGB565 ? 1 : 0;  // 16 / step
+    int shiftG = format == BM_CPU_FORMAT_RGB565 ? 2 : 0;
+    for (int i = 0; i < 4; ++i) {
+        int t = bm_cpu__bayer[y & 3][i];
+        out[i * 4 + 0] = (uint8_t)(t >> shiftR);
+        out[i * 4 + 1] = (uint8_t)(t >> shiftG);
+        out[i * 4 + 2] = (uint8_t)(t >> shiftR);
+        out[i * 4 + 3] = 0;
+    }
+}
+
+static inline uint16_t
+bm_cpu__to16(uint32_t p, BM_CPUFormat format)
+{
+    if (format == BM_CPU_FORMAT_RGB565) {
+        return (uint16_t)(((p >> 8) & 0xF800u) | ((p >> 5) & 0x07E0u) | ((p >> 3) & 0x001Fu));
+    }
+    return (uint16_t)(((p >> 12) & 0x0F00u) | ((p >> 8) & 0x00F0u) | ((p >> 4) & 0x000Fu));
+}
+
+// ARGB row -> 16-bit row, optionally adding the dither bias
+// (saturating) before truncation. 8 pixels per SSE2 step.
+static void
+bm_cpu__convert_row(uint16_t *dst, const uint32_t *src, int n,
+                    BM_CPUFormat format, const uint8_t *bias)
+{
+    int x = 0;
+#ifdef BM_CPU__SSE2
+    __m128i vb = bias ? _mm_loadu_si128((const __m128i *)bias) : _mm_setzero_si128();
+    __m128i m0, m1, m2;
+    int     s0, s1, s2;
+    if (format == BM_CPU_FORMAT_RGB565) {
+        m0 = _mm_set1_epi32(0xF800); s0 = 8;
+        m1 = _mm_set1_epi32(0x07E0); s1 = 5;
+        m2 = _mm_set1_epi32(0x001F); s2 = 3;
+    } else {
+        m0 = _mm_set1_epi32(0x0F00); s0 = 12;
+        m1 = _mm_set1_epi32(0x00F0); s1 = 8;
+        m2 = _mm_set1_epi32(0x000F); s2 = 4;
+    }
+    __m128i c0 = _mm_cvtsi32_si128(s0);
+    __m128i c1 = _mm_cvtsi32_si128(s1);
+    __m128i c2 = _mm_cvtsi32_si128(s2);
+    for (; x + 8 <= n; x += 8) {
+        __m128i a = _mm_adds_epu8(_mm_loadu_si128((const __m128i *)(src + x)),     vb);
+        __m128i b = _mm_adds_epu8(_mm_loadu_si128((const __m128i *)(src + x + 4)), vb);
+        a = _mm_or_si128(_mm_or_si128(_mm_and_si128(_mm_srl_epi32(a, c0), m0),
+                                      _mm_and_si128(_mm_srl_epi32(a, c1), m1)),
+                         _mm_and_si128(_mm_srl_epi32(a, c2), m2));
+        b = _mm_or_si128(_mm_or_si128(_mm_and_si128(_mm_srl_epi32(b, c0), m0),
+                                      _mm_and_si128(_mm_srl_epi32(b, c1), m1)),
+                         _mm_and_si128(_mm_srl_epi32(b, c2), m2));
+        // Sign-extend the low halves so the signed pack is exact.
+        a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+        b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+        _mm_storeu_si128((__m128i *)(dst + x), _mm_packs_epi32(a, b));
+    }
+#endif
+    for (; x < n; ++x) {
+        uint32_t p = src[x];
+        if (bias) {
+            const uint8_t *b = &bias[(x & 3) * 4];
+            uint32_t out = p & 0xFF000000u;
+            for (int ch = 0; ch < 3; ++ch) {
+                uint32_t v = ((p >> (ch * 8)) & 0xFFu) + b[ch];
+                out |= (v > 255u ? 255u : v) << (ch * 8);
+            }
+            p = out;
+        }
+        dst[x] = bm_cpu__to16(p, format);
+    }
+}
+
+// Integer upscale of the canvas, centered, letterbox = clear color,
+// converted to the output format.
+static void
+bm_cpu__present(BM_CPURenderer *r, uint32_t clear)
+{
+    int pitch = r->pitch ? r->pitch : r->width;
+    int wide  = r->format == BM_CPU_FORMAT_ARGB8888;
+
+    int scaleX   = r->width  / r->canvasW;
+    int scaleY   = r->height / r->canvasH;
+    int intScale = scaleX < scaleY ? scaleX : scaleY;
+    if (intScale < 1) intScale = 1;
+
+    int outW = r->canvasW * intScale;
+    int outH = r->canvasH * intScale;
+    int offX = (r->width  - outW) / 2;
+    int offY = (r->height - outH) / 2;
+
+    if (!wide && r->outRowCapacity < r->width) {
+        uint32_t *row = (uint32_t *)realloc(r->outRow, (size_t)r->width * sizeof(uint32_t));
+        if (!row) return;
+        r->outRow         = row;
+        r->outRowCapacity = r->width;
+    }
+    int     dither = !wide && r->dither;
+    uint8_t bias[16];
+
+    for (int y = 0; y < r->height; ++y) {
+        int sy     = y - offY;
+        int inside = sy >= 0 && sy < outH;
+
+        // Same content as the row above: the same canvas row, or
+        // letterbox under letterbox.
+        int repeat = y > 0 && (inside ? sy % intScale != 0
+                                      : (sy - 1 < 0 || sy - 1 >= outH));
+
+        uint32_t *row32 = wide ? (uint32_t *)r->pixels + (size_t)y * (size_t)pitch : r->outRow;
+        uint16_t *row16 = wide ? NULL : (uint16_t *)r->pixels + (size_t)y * (size_t)pitch;
+
+        // Rows repeated by the vertical scale (and letterbox rows)
+        // are copies, unless dithering makes every row different.
+        if (repeat && !dither) {
+            if (wide) memcpy(row32, row32 - pitch, (size_t)r->width * sizeof(uint32_t));
+            else      memcpy(row16, row16 - pitch, (size_t)r->width * sizeof(uint16_t));
+            continue;
+        }
+
+        if (!repeat) {
+            if (!inside) {
+                for (int x = 0; x < r->width; ++x) row32[x] = clear;
+            } else {
+                const uint32_t *src;
+                if (r->drawIndexed) {
+                    bm_cpu__expand_row(r->rowScratch,
+                                       r->canvas8 + (size_t)(sy / intScale) * (size_t)r->canvasW,
+                                       r->canvasW, r->palette, r->paletteSize);
+                    src = r->rowScratch;
+                } else {
+                    src = r->canvas + (size_t)(sy / intScale) * (size_t)r->canvasW;
+                }
+                bm_cpu__scale_row(row32, r->width, src, offX, outW, intScale, clear);
+            }
+        }
+
+        if (!wide) {
+            if (dither) bm_cpu__dither_bias(r->format, y, bias);
+            bm_cpu__convert_row(row16, r->outRow, r->width, r->format,
+                                dither ? bias : NULL);
+        }
+    }
+}
+
+// ------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------
+
+static int
+bm_cpu__bind(BM_CPURenderer *r, BM_TextureId id,
+             const uint32_t *pixels, const uint8_t *indices,
+             int width, int height)
+{
+    if (!r || id < 0) return 0;
+    if (id >= r->textureCount) {
+        int newCount = r->textureCount ? r->textureCount : 16;
+        while (newCount <= id) newCount *= 2;
+
+        BM_CPUTexture *t = (BM_CPUTexture *)realloc(r->textures,
+                                                    (size_t)newCount * sizeof(BM_CPUTexture));
+        if (!t) return 0;
+        for (int i = r->textureCount; i < newCount; ++i) {
+            t[i].pixels  = NULL;
+            t[i].indices = NULL;
+            t[i].width   = 0;
+            t[i].height  = 0;
+        }
+        r->textures     = t;
+        r->textureCount = newCount;
+    }
+    int valid = width > 0 && height > 0;
+    r->textures[id].pixels  = valid ? pixels  : NULL;
+    r->textures[id].indices = valid ? indices : NULL;
+    r->textures[id].width   = width;
+    r->textures[id].height  = height;
+    return 1;
+}
+
+// Binds a BangerMan texture id to ARGB8888 pixels (NULL unbinds).
+// Pixels stay owned by the caller and must outlive rendering.
+int
+BM_CPU_SetTexture(BM_CPURenderer *r, BM_TextureId id,
+                  const uint32_t *pixels, int width, int height)
+{
+    return bm_cpu__bind(r, id, pixels, NULL, width, height);
+}
+
+// Binds a texture id to 8-bit palette indices, index 0 transparent.
+// Drawn as-is in indexed mode and through the palette otherwise.
+int
+BM_CPU_SetTextureIndexed(BM_CPURenderer *r, BM_TextureId id,
+                         const uint8_t *indices, int width, int height)
+{
+    return bm_cpu__bind(r, id, NULL, indices, width, height);
+}
+
+// Replays an explicit command view (e.g. a loaded capture frame)
+// without going through a BM_Context.
+void
+BM_CPU_RenderCommands(BM_CPURenderer       *r,
+                      const BM_CommandView *view,
+                      float                 logicalW,
+                      float                 logicalH,
+                      BM_Color              clear)
+{
+    if (!r || !view || !r->pixels) return;
+
+#ifdef BM_ENABLE_STATS
+    double startTime = bm_time_seconds();
+    int    drawCalls = 0;
+#endif
+
+    // Frame palette, padded to 256 entries so any index is valid.
+    int paletteSize = view->palette ? view->palette_size : 0;
+    memset(r->palette, 0, sizeof(r->palette));
+    if (paletteSize > 0) {
+        memcpy(r->palette, view->palette, (size_t)paletteSize * sizeof(uint32_t));
+    }
+    r->paletteSize = paletteSize;
+    r->drawIndexed = r->indexed && paletteSize > 0;
+
+    // --------------------------------------------------------
+    // 1) (Re)allocate the logical canvas, clear it
+    // --------------------------------------------------------
+    if (!bm_cpu__ensure_canvas(r, (int)(logicalW + 0.5f),
+                                  (int)(logicalH + 0.5f))) return;
+
+    BM_PROFILE_BEGIN("bm_cpu_clear");
+    uint32_t clearPx;
+    size_t   pixelCount = (size_t)r->canvasW * (size_t)r->canvasH;
+    if (r->drawIndexed) {
+        uint32_t idx = bm_cpu__pack_index(r, paletteSize, clear) & 0xFFu;
+        memset(r->canvas8, (int)idx, pixelCount);
+        clearPx = r->palette[idx];
+    } else {
+        clearPx = bm_cpu__pack(bm_resolve_color(view, clear));
+        for (size_t i = 0; i < pixelCount; ++i) r->canvas[i] = clearPx;
+    }
+    BM_PROFILE_END("bm_cpu_clear");
+
+    // --------------------------------------------------------
+    // 2) Rasterize commands at logical resolution
+    // --------------------------------------------------------
+    BM_PROFILE_BEGIN("bm_cpu_raster");
+    BM_Color lastColor = clear;
+    uint32_t c         = 0;
+    int      haveColor = 0;
+    BM_CommandIter it = bm_command_iter(view);
+    for (const BM_Command *cmd; (cmd = bm_command_next(&it)) != NULL; ) {
+
+        // Nearest-entry search only when the color changes.
+        if (!haveColor || memcmp(&cmd->color, &lastColor, sizeof(BM_Color)) != 0) {
+            lastColor = cmd->color;
+            haveColor = 1;
+            c = r->drawIndexed ? bm_cpu__pack_index(r, paletteSize, cmd->color)
+                               : bm_cpu__pack(bm_resolve_color(view, cmd->color));
+        }
+#ifdef BM_ENABLE_STATS
+        ++drawCalls;
+#endif
+
+        switch (cmd->type) {
+        case BM_CMD_RECT_FILL:
+            bm_cpu__rect_fill(r, cmd, c);
+            break;
+
+        case BM_CMD_RECT_OUTLINE:
+            bm_cpu__rect_outline(r, cmd, c);
+            break;
+
+        case BM_CMD_LINE:
+            bm_cpu__line(r, cmd, c);
+            break;
+
+        case BM_CMD_SPRITE: {
+            const BM_CPUTexture *tex = bm_cpu__texture(r, cmd->texture);
+            if (!tex) break;
+            bm_cpu__blit(r, tex, cmd->x, cmd->y, cmd->w, cmd->h,
+                         0.0f, 0.0f, 1.0f, 1.0f, c);
+        } break;
+
+#ifndef BM_CONFIG_NO_TEXT
+        case BM_CMD_TEXT: {
+            const BM_CPUTexture *tex = bm_cpu__texture(r, cmd->texture);
+            int n = 0;
+            const BM_GlyphQuad *q = bm_text_get_quads(cmd, &n);
+            if (!tex || !q) break;
+            for (int g = 0; g < n; ++g) {
+                bm_cpu__blit(r, tex,
+                             cmd->x + q[g].x, cmd->y + q[g].y, q[g].w, q[g].h,
+                             q[g].u0, q[g].v0, q[g].u1, q[g].v1, c);
+            }
+        } break;
+#endif
+
+#ifndef BM_CONFIG_NO_TILEMAPS
+        case BM_CMD_TILEMAP: {
+            const BM_CPUTexture *tex = bm_cpu__texture(r, cmd->texture);
+            if (!tex || !cmd->object) break;
+            const BM_Tilemap *map = (const BM_Tilemap *)cmd->object;
+
+            BM_TileQuad quads[BM_TILEMAP_CHUNK * BM_TILEMAP_CHUNK];
+            int cx0, cy0, cx1, cy1;
+            bm_tilemap_get_visible(cmd, &cx0, &cy0, &cx1, &cy1);
+            for (int cy = cy0; cy < cy1; ++cy) {
+                for (int cx = cx0; cx < cx1; ++cx) {
+                    int n = bm_tilemap_build_chunk(map, cx, cy, quads);
+                    for (int k = 0; k < n; ++k) {
+                        bm_cpu__blit(r, tex,
+                                     cmd->x + quads[k].x, cmd->y + quads[k].y,
+                                     quads[k].w, quads[k].h,
+                                     quads[k].u0, quads[k].v0,
+                                     quads[k].u1, quads[k].v1, c);
+                    }
+                }
+            }
+        } break;
+#endif
+
+#ifndef BM_CONFIG_NO_SHAPES
+        case BM_CMD_ELLIPSE_FILL:
+        case BM_CMD_ELLIPSE_OUTLINE:
+            bm_cpu__ellipse(r, cmd, cmd->type == BM_CMD_ELLIPSE_OUTLINE, c);
+            break;
+
+        case BM_CMD_POLYGON_FILL:
+        case BM_CMD_POLYGON_OUTLINE: {
+            const BM_Point *p = bm_polygon_get_points(view, cmd);
+            int             m = (int)cmd->count;
+            if (!p) break;
+            if (cmd->type == BM_CMD_POLYGON_FILL) {
+                bm_cpu__polygon_fill(r, p, m, c);
+            } else {
+                for (int k = 0, j = m - 1; k < m; j = k++) {
+                    bm_cpu__segment(r, p[j].x, p[j].y, p[k].x, p[k].y, c);
+                }
+            }
+        } break;
+
+        case BM_CMD_POLYLINE: {
+            // Each pair of edge rows is a convex quad; aliased like
+            // every other CPU primitive.
+            const BM_Point *p = bm_polygon_get_points(view, cmd);
+            int             m = (int)cmd->count;
+            if (!p || !bm_cpu__reserve_rows(r, 4 * m)) break;
+            int rows = bm_polyline_tessellate(p, m, cmd->x2 * 0.5f, 4.0f, r->rows);
+            for (int k = 0; k + 1 < rows; ++k) {
+                const BM_Point *a = &r->rows[k * 2];
+                BM_Point quad[4] = { a[0], a[2], a[3], a[1] };
+                bm_cpu__polygon_fill(r, quad, 4, c);
+            }
+        } break;
+#endif
+
+#ifndef BM_CONFIG_NO_PARTICLES
+        case BM_CMD_PARTICLES: {
+            BM_ParticleView pv;
+            bm_particles_get_view(cmd, &pv);
+            if (pv.count == 0) break;
+
+            float half = pv.size * 0.5f;
+            if (r->drawIndexed) {
+                // No fade in indexed mode: every particle uses the
+                // command color's index.
+                for (int p = 0; p < pv.count; ++p) {
+                    BM_Command q;
+                    q.x = pv.x[p] - half;
+                    q.y = pv.y[p] - half;
+                    q.w = pv.size;
+                    q.h = pv.size;
+                    bm_cpu__rect_fill(r, &q, c);
+                }
+                break;
+            }
+
+            BM_Color t0 = bm_resolve_color(view, cmd->color);
+            BM_Color t1 = t0;
+            t0.r *= pv.color_start.r; t0.g *= pv.color_start.g;
+            t0.b *= pv.color_start.b; t0.a *= pv.color_start.a;
+            t1.r *= pv.color_end.r;   t1.g *= pv.color_end.g;
+            t1.b *= pv.color_end.b;   t1.a *= pv.color_end.a;
+
+            for (int p = 0; p < pv.count; ++p) {
+                float    t = pv.t[p];
+                BM_Color pc = { t0.r + (t1.r - t0.r) * t, t0.g + (t1.g - t0.g) * t,
+                                t0.b + (t1.b - t0.b) * t, t0.a + (t1.a - t0.a) * t, 0 };
+                BM_Command q;
+                q.x = pv.x[p] - half;
+                q.y = pv.y[p] - half;
+                q.w = pv.size;
+                q.h = pv.size;
+                bm_cpu__rect_fill(r, &q, bm_cpu__pack(pc));
+            }
+        } break;
+#endif
+
+        default:
+            // Unknown command type, ignore.
+            break;
+        }
+    }
+    BM_PROFILE_END("bm_cpu_raster");
+
+    // --------------------------------------------------------
+    // 3) Upscale into the output buffer
+    // --------------------------------------------------------
+    BM_PROFILE_BEGIN("bm_cpu_present");
+    bm_cpu__present(r, clearPx);
+    BM_PROFILE_END("bm_cpu_present");
+
+#ifdef BM_ENABLE_STATS
+    r->stats.draw_calls     = drawCalls;
+    r->stats.state_changes  = 0;  // no GPU-style state to change
+    r->stats.replay_seconds = bm_time_seconds() - startTime;
+#endif
+}
+
+void
+BM_CPU_Render(BM_CPURenderer *r,
+              BM_Context     *ctx)
+{
+    if (!r || !ctx) return;
+
+    BM_CommandView view = {0};
+    bm_get_commands(ctx, &view);
+
+    float logicalW = 320.0f;
+    float logicalH = 180.0f;
+    bm_context_get_logical_size(ctx, &logicalW, &logicalH);
+
+    BM_CPU_RenderCommands(r, &view, logicalW, logicalH,
+                          bm_context_get_clear_color(ctx));
+
+#ifdef BM_ENABLE_STATS
+    bm_report_backend_stats(ctx, &r->stats);
+#endif
+}
+
+void
+BM_CPU_Destroy(BM_CPURenderer *r)
+{
+    if (!r) return;
+    free(r->canvas);
+    free(r->canvas8);
+    free(r->rowScratch);
+    free(r->outRow);
+    r->outRow         = NULL;
+    r->outRowCapacity = 0;
+    r->canvas8      = NULL;
+    r->rowScratch   = NULL;
+    free(r->textures);
+    free(r->rows);
+    r->rows         = NULL;
+    r->rowCapacity  = 0;
+    r->canvas       = NULL;
+    r->canvasW      = 0;
+    r->canvasH      = 0;
+    r->textures     = NULL;
+    r->textureCount = 0;
+}
@@ -3,111 +3,1789 @@
 // BangDev / Crayon playground
 // ------------------------------------------------------------
 // - Consumes BM_Command buffer
-// - Applies integer scaling to keep pixel-art sharp
+// - Applies integer scaling to keep pixel-art sharp, or renders a
+//   logical-size canvas and scales it (BM_SDL3ScaleMode)
 // - Centers the logical canvas in the SDL window
+// - Two phases: BM_SDL3_Prepare turns commands into a vertex
+//   batch without touching SDL_Renderer (any thread),
+//   BM_SDL3_Submit draws a batch (render thread)
 // ============================================================
+//
+// Pipelined use: prepare frame N + 1 on a worker while the main
+// thread submits and presents frame N, ping-ponging two batches.
+//
+//   // main, per frame (ctx recorded, previous prepare joined):
+//   start_worker(BM_SDL3_Prepare, &r, &batch[n & 1], ctx, outW, outH);
+//   BM_SDL3_Submit(&r, &batch[(n - 1) & 1]);
+//   SDL_RenderPresent(renderer);
+//   join_worker();
+//
+// Prepare uses the renderer's caches (shapes, tilemaps), so only one
+// prepare may run per renderer at a time; it may overlap any number
+// of submits. Textures are looked up at submit time. The context
+// (and the fonts, tilemaps, emitters its commands point at) must not
+// be modified while it is being prepared.
+//
+// Large frames can be prepared on several threads: set `threads`
+// (and optionally `parallelFor` to use an existing job system).
+// Rect, sprite and line runs are split into fixed ranges whose
+// vertices are written straight into their slice of the batch.
 
 #include <SDL3/SDL.h>
 #include "bangerman.h"
 
-void
-BM_SDL3_Render(SDL_Renderer *renderer,
-               BM_Context   *ctx,
-               int           windowWidth,
-               int           windowHeight)
+// BM_SDL3_NO_SIMD forces the scalar transform (for comparison).
+#if (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) && \
+    !defined(BM_SDL3_NO_SIMD)
+#define BM_SDL3__SSE2 1
+#include <emmintrin.h>
+#endif
+
+// Cached geometry of one tilemap chunk, in map pixels.
+typedef struct {
+    uint32_t     version;   // bm_tilemap_chunk_version when built, 0 = never
+    BM_TileQuad *quads;
+    int          quadCount;
+} BM_SDL3Chunk;
+
+typedef struct {
+    const BM_Tilemap *map;
+    int               cols;
+    int               rows;
+    BM_SDL3Chunk     *chunks;
+    Uint64            lastUsed;  // renderSerial of last draw
+} BM_SDL3TilemapCache;
+
+// Tessellated ellipse outline: offsets from the center in output
+// pixels, keyed by radii and scale so repeated shapes (bullets,
+// markers, UI knobs) are only tessellated once.
+typedef struct {
+    float       rx, ry;     // logical radii
+    int         scale;      // 0 = empty slot
+    int         segments;
+    SDL_FPoint *ring;
+} BM_SDL3EllipseTess;
+
+// Direct-mapped ellipse tessellation cache size (power of two).
+#ifndef BM_SDL3_SHAPE_CACHE_SIZE
+#define BM_SDL3_SHAPE_CACHE_SIZE 64
+#endif
+
+// Quads merged into one geometry draw (rect runs, particles, sprites
+// sharing a texture); bounds the shared index pattern.
+#ifndef BM_SDL3_MAX_BATCH_QUADS
+#define BM_SDL3_MAX_BATCH_QUADS 65536
+#endif
+
+// Tilemap caches not drawn for this many renders are dropped.
+#ifndef BM_SDL3_TILEMAP_CACHE_FRAMES
+#define BM_SDL3_TILEMAP_CACHE_FRAMES 120
+#endif
+
+// Commands per range of the parallel prepare, and the smallest
+// frame worth splitting (smaller frames are prepared serially).
+#ifndef BM_SDL3_PARALLEL_CHUNK
+#define BM_SDL3_PARALLEL_CHUNK 16384
+#endif
+
+#ifndef BM_SDL3_PARALLEL_MIN
+#define BM_SDL3_PARALLEL_MIN 65536
+#endif
+
+// How the logical canvas is fitted to the output. INTEGER draws
+// commands straight to the output; the other modes draw them once
+// into a logical-size canvas texture and scale that as one quad, so
+// primitive cost does not grow with the window.
+typedef enum {
+    BM_SDL3_SCALE_INTEGER,  // largest integer scale, letterboxed
+    BM_SDL3_SCALE_SHARP,    // fit, fractional: integer nearest prescale,
+                            // then bilinear (sharp-bilinear)
+    BM_SDL3_SCALE_FIT,      // fit, fractional, nearest (uneven pixels)
+    BM_SDL3_SCALE_FILL,     // cover the output, cropping; nearest
+} BM_SDL3ScaleMode;
+
+// Where the logical canvas lands in the output. Cached by the
+// renderer, recomputed only when the output size, logical size or
+// mode changes; also handy to map window coordinates back to
+// logical ones: lx = (wx - x) * logicalW / w.
+typedef struct {
+    int              outputW, outputH;  // inputs it was computed for
+    float            logicalW, logicalH;
+    BM_SDL3ScaleMode mode;
+    int              scale;             // INTEGER: scale. SHARP:
+                                        // prescale. 0 = not computed
+    float            x, y;              // canvas origin in output pixels
+    float            w, h;              // canvas size in output pixels
+    int              canvasW, canvasH;  // canvas texture, 0 = none
+} BM_SDL3Viewport;
+
+// Render target texture owned by the renderer.
+typedef struct {
+    SDL_Texture *texture;
+    int          w, h;
+} BM_SDL3Target;
+
+// One draw of a prepared batch. Geometry draws index their vertex
+// range with one of the batch's shared index patterns.
+typedef enum {
+    BM_SDL3_DRAW_QUADS,  // 4 vertices per quad
+    BM_SDL3_DRAW_FAN,    // convex fill, triangles (0, i, i + 1)
+    BM_SDL3_DRAW_STRIP,  // polyline rows of 4 vertices
+    BM_SDL3_DRAW_LINES,  // SDL_RenderLines over points
+} BM_SDL3DrawKind;
+
+typedef struct {
+    BM_SDL3DrawKind kind;
+    BM_TextureId    texture;  // geometry: -1 = untextured
+    BM_Color        color;    // lines: draw color (resolved)
+    int             first;    // first vertex / point
+    int             count;    // vertices / points
+} BM_SDL3Draw;
+
+// A frame converted to output-space geometry by BM_SDL3_Prepare and
+// drawn by BM_SDL3_Submit. Zero-initialize; buffers are kept and
+// only grow, so steady-state frames do not allocate.
+typedef struct {
+    SDL_Vertex  *vertices;
+    int          vertexCount;
+    int          vertexCapacity;
+    SDL_FPoint  *points;         // outlines drawn as lines
+    int          pointCount;
+    int          pointCapacity;
+    BM_SDL3Draw *draws;
+    int          drawCount;
+    int          drawCapacity;
+
+    // Index patterns: the pattern for n primitives is a prefix of
+    // the one for n + 1, so one buffer serves every draw of a kind.
+    int         *quadIndices;
+    int          quadCapacity;   // in quads
+    int         *fanIndices;
+    int          fanCapacity;    // in vertices
+    int         *stripIndices;
+    int          stripCapacity;  // in rows
+
+    BM_Color        clear;       // resolved clear color
+    BM_SDL3Viewport viewport;    // canvasW != 0: geometry is in
+                                 // canvas pixels, scaled by Submit
+    int             complete;    // 0 if prepare ran out of memory
+
+#ifdef BM_ENABLE_STATS
+    double       prepareSeconds;
+#endif
+} BM_SDL3Batch;
+
+// Runs task(data, 0) .. task(data, count - 1), possibly
+// concurrently, and returns when all have finished.
+typedef void (*BM_SDL3ParallelFor)(void (*task)(void *data, int index),
+                                   void *data, int count, void *user);
+
+// A fixed slice of a frame's commands in the parallel prepare. The
+// split does not depend on the thread count, so neither does the
+// batch.
+typedef struct {
+    size_t first;       // command index
+    size_t count;
+    int    simple;      // only commands bm_sdl3__simple_counts takes
+    int    vertices;    // geometry of the range
+    int    points;
+    int    draws;       // upper bound: commands with geometry
+    int    vertexBase;  // slice offsets in the batch / rangeDraws
+    int    pointBase;
+    int    drawBase;
+    int    drawCount;   // range-local draws written
+} BM_SDL3Range;
+
+typedef struct BM_SDL3Pool BM_SDL3Pool;
+
+typedef struct {
+    SDL_Renderer *renderer;
+
+    // Draw BM_CMD_LINE as 1px anti-aliased strips instead of
+    // SDL_RenderLine (polylines are always anti-aliased).
+    int           smoothLines;
+
+    // BM_CMD_RECT_OUTLINE border width in logical pixels (scaled
+    // like fills); 0 = one output pixel, as SDL_RenderRect draws.
+    float         outlineThickness;
+
+    // BM_TextureId -> SDL_Texture (caller-owned), see BM_SDL3_SetTexture
+    SDL_Texture **textures;
+    int           textureCount;
+
+    // Prepare-side caches: ellipse tessellations, polyline edge
+    // rows from bm_polyline_tessellate
+    BM_SDL3EllipseTess  ellipses[BM_SDL3_SHAPE_CACHE_SIZE];
+    BM_Point           *rows;
+    int                 rowCapacity;   // in points
+
+    // Per-tilemap chunk geometry caches
+    BM_SDL3TilemapCache *tilemaps;
+    int                  tilemapCount;
+    Uint64               renderSerial;
+
+    // Batch used by BM_SDL3_Render / BM_SDL3_RenderCommands
+    BM_SDL3Batch         batch;
+
+    // Canvas scaling; see BM_SDL3ScaleMode
+    BM_SDL3ScaleMode     scaleMode;
+
+    // INTEGER mode through the canvas too: rasterize at logical size
+    // and upscale once with nearest filtering, cutting fill cost by
+    // scale^2. Smooth lines, polylines and ellipse edges are then
+    // anti-aliased / tessellated at logical resolution.
+    int                  logicalCanvas;
+
+    // Viewport of the last submitted batch (read-only)
+    BM_SDL3Viewport      viewport;
+
+    // Logical canvas and its SHARP prescale (render thread)
+    BM_SDL3Target        canvas;
+    BM_SDL3Target        prescaled;
+
+    // Parallel prepare of frames of BM_SDL3_PARALLEL_MIN commands
+    // or more: up to `threads` threads including the caller; <= 1 =
+    // serial. parallelFor = NULL uses a built-in thread pool.
+    int                  threads;
+    BM_SDL3ParallelFor   parallelFor;
+    void                *parallelUser;
+
+    BM_SDL3Pool         *pool;
+    BM_SDL3Range        *ranges;
+    int                  rangeCapacity;
+    BM_SDL3Draw         *rangeDraws;
+    int                  rangeDrawCapacity;
+
+#ifdef BM_ENABLE_STATS
+    BM_BackendStats stats;  // last replay
+#endif
+} BM_SDL3Renderer;
+
+// ------------------------------------------------------------
+// Internal helpers
+// ------------------------------------------------------------
+
+static SDL_Texture *
+bm_sdl3__texture(const BM_SDL3Renderer *r, BM_TextureId id)
+{
+    if (id < 0 || id >= r->textureCount) return NULL;
+    return r->textures[id];
+}
+
+// Doubling growth shared by the scratch arrays below.
+static int
+bm_sdl3__next_capacity(int capacity, int need, int minimum)
+{
+    int newCap = capacity ? capacity * 2 : minimum;
+    return newCap < need ? need : newCap;
+}
+
+static int
+bm_sdl3__reserve_vertices(BM_SDL3Batch *b, int verts)
+{
+    if (verts <= b->vertexCapacity) return 1;
+    int newCap = bm_sdl3__next_capacity(b->vertexCapacity, verts, 1024);
+    SDL_Vertex *v = (SDL_Vertex *)SDL_realloc(b->vertices, (size_t)newCap * sizeof(SDL_Vertex));
+    if (!v) return 0;
+    b->vertices       = v;
+    b->vertexCapacity = newCap;
+    return 1;
+}
+
+static int
+bm_sdl3__reserve_points(BM_SDL3Batch *b, int points)
+{
+    if (points <= b->pointCapacity) return 1;
+    int newCap = bm_sdl3__next_capacity(b->pointCapacity, points, 256);
+    SDL_FPoint *p = (SDL_FPoint *)SDL_realloc(b->points, (size_t)newCap * sizeof(SDL_FPoint));
+    if (!p) return 0;
+    b->points        = p;
+    b->pointCapacity = newCap;
+    return 1;
+}
+
+static int
+bm_sdl3__reserve_draws(BM_SDL3Batch *b, int draws)
+{
+    if (draws <= b->drawCapacity) return 1;
+    int newCap = bm_sdl3__next_capacity(b->drawCapacity, draws, 256);
+    BM_SDL3Draw *d = (BM_SDL3Draw *)SDL_realloc(b->draws, (size_t)newCap * sizeof(BM_SDL3Draw));
+    if (!d) return 0;
+    b->draws        = d;
+    b->drawCapacity = newCap;
+    return 1;
+}
+
+// Quad index pattern; indices are written once here.
+static int
+bm_sdl3__reserve_quads(BM_SDL3Batch *b, int quads)
+{
+    if (quads <= b->quadCapacity) return 1;
+
+    int newCap = b->quadCapacity ? b->quadCapacity * 2 : 256;
+    if (newCap < quads) newCap = quads;
+
+    int *idx = (int *)SDL_realloc(b->quadIndices, (size_t)newCap * 6 * sizeof(int));
+    if (!idx) return 0;
+    for (int q = b->quadCapacity; q < newCap; ++q) {
+        int *i = &idx[q * 6];
+        int  v = q * 4;
+        i[0] = v + 0; i[1] = v + 1; i[2] = v + 2;
+        i[3] = v + 2; i[4] = v + 3; i[5] = v + 0;
+    }
+    b->quadIndices  = idx;
+    b->quadCapacity = newCap;
+    return 1;
+}
+
+// Triangle fan over `verts` vertices: triangles (0, i, i + 1).
+static int
+bm_sdl3__reserve_fan(BM_SDL3Batch *b, int verts)
+{
+    if (verts <= b->fanCapacity) return 1;
+
+    int newCap = b->fanCapacity ? b->fanCapacity * 2 : 64;
+    if (newCap < verts) newCap = verts;
+
+    int *idx = (int *)SDL_realloc(b->fanIndices, (size_t)(newCap - 2) * 3 * sizeof(int));
+    if (!idx) return 0;
+    int from = b->fanCapacity > 2 ? b->fanCapacity - 2 : 0;
+    for (int t = from; t < newCap - 2; ++t) {
+        idx[t * 3 + 0] = 0;
+        idx[t * 3 + 1] = t + 1;
+        idx[t * 3 + 2] = t + 2;
+    }
+    b->fanIndices  = idx;
+    b->fanCapacity = newCap;
+    return 1;
+}
+
+// Polyline vertices come in rows of 4 (feather, edge, edge, feather);
+// consecutive rows are joined by 3 quads = 18 indices.
+static int
+bm_sdl3__reserve_strip(BM_SDL3Batch *b, int rows)
+{
+    if (rows <= b->stripCapacity) return 1;
+
+    int newCap = b->stripCapacity ? b->stripCapacity * 2 : 256;
+    if (newCap < rows) newCap = rows;
+
+    int *idx = (int *)SDL_realloc(b->stripIndices, (size_t)(newCap - 1) * 18 * sizeof(int));
+    if (!idx) return 0;
+    int from = b->stripCapacity > 1 ? b->stripCapacity - 1 : 0;
+    for (int k = from; k < newCap - 1; ++k) {
+        int *i = &idx[k * 18];
+        int  a = k * 4;
+        int  c = a + 4;
+        for (int q = 0; q < 3; ++q, i += 6) {
+            i[0] = a + q; i[1] = a + q + 1; i[2] = c + q + 1;
+            i[3] = c + q + 1; i[4] = c + q; i[5] = a + q;
+        }
+    }
+    b->stripIndices  = idx;
+    b->stripCapacity = newCap;
+    return 1;
+}
+
+static BM_SDL3Draw *
+bm_sdl3__push_draw(BM_SDL3Batch *b, BM_SDL3DrawKind kind, BM_TextureId texture,
+                   int first, int count)
+{
+    if (!bm_sdl3__reserve_draws(b, b->drawCount + 1)) return NULL;
+    BM_SDL3Draw *d = &b->draws[b->drawCount++];
+    d->kind    = kind;
+    d->texture = texture;
+    d->first   = first;
+    d->count   = count;
+    return d;
+}
+
+// Whether `verts` quad vertices with `texture` starting at vertex
+// `first` may extend draw d.
+static int
+bm_sdl3__extends(const BM_SDL3Draw *d, BM_TextureId texture, int first, int verts)
+{
+    return d && d->kind == BM_SDL3_DRAW_QUADS && d->texture == texture &&
+           d->first + d->count == first &&
+           (d->count + verts) / 4 <= BM_SDL3_MAX_BATCH_QUADS;
+}
+
+// Appends `quads` quads and returns their vertices. Quads extend the
+// previous draw when it is a quad draw with the same texture, so rect
+// runs (color is per vertex), particles and same-atlas sprites are
+// one submission up to BM_SDL3_MAX_BATCH_QUADS. A single larger
+// request (a big tilemap) still gets one draw.
+static SDL_Vertex *
+bm_sdl3__quads(BM_SDL3Batch *b, BM_TextureId texture, int quads)
+{
+    int verts = quads * 4;
+    if (!bm_sdl3__reserve_vertices(b, b->vertexCount + verts)) return NULL;
+
+    BM_SDL3Draw *d = b->drawCount ? &b->draws[b->drawCount - 1] : NULL;
+    if (bm_sdl3__extends(d, texture, b->vertexCount, verts)) {
+        d->count += verts;
+    } else {
+        d = bm_sdl3__push_draw(b, BM_SDL3_DRAW_QUADS, texture, b->vertexCount, verts);
+        if (!d) return NULL;
+    }
+    if (!bm_sdl3__reserve_quads(b, d->count / 4)) {
+        d->count -= verts;
+        return NULL;
+    }
+
+    SDL_Vertex *v = &b->vertices[b->vertexCount];
+    b->vertexCount += verts;
+    return v;
+}
+
+// Appends an untextured fan or strip draw of `verts` vertices.
+static SDL_Vertex *
+bm_sdl3__shape(BM_SDL3Batch *b, BM_SDL3DrawKind kind, int verts)
+{
+    int ok = kind == BM_SDL3_DRAW_FAN ? bm_sdl3__reserve_fan(b, verts)
+                                      : bm_sdl3__reserve_strip(b, verts / 4);
+    if (!ok ||
+        !bm_sdl3__reserve_vertices(b, b->vertexCount + verts) ||
+        !bm_sdl3__push_draw(b, kind, -1, b->vertexCount, verts)) return NULL;
+
+    SDL_Vertex *v = &b->vertices[b->vertexCount];
+    b->vertexCount += verts;
+    return v;
+}
+
+// Appends a connected line through `points` points.
+static SDL_FPoint *
+bm_sdl3__lines(BM_SDL3Batch *b, BM_Color color, int points)
+{
+    if (!bm_sdl3__reserve_points(b, b->pointCount + points)) return NULL;
+    BM_SDL3Draw *d = bm_sdl3__push_draw(b, BM_SDL3_DRAW_LINES, -1, b->pointCount, points);
+    if (!d) return NULL;
+    d->color = color;
+
+    SDL_FPoint *p = &b->points[b->pointCount];
+    b->pointCount += points;
+    return p;
+}
+
+static void
+bm_sdl3__quad(SDL_Vertex *v,
+              float x, float y, float w, float h,
+              float u0, float v0, float u1, float v1,
+              SDL_FColor c)
+{
+    v[0].position.x = x;     v[0].position.y = y;
+    v[1].position.x = x + w; v[1].position.y = y;
+    v[2].position.x = x + w; v[2].position.y = y + h;
+    v[3].position.x = x;     v[3].position.y = y + h;
+
+    v[0].tex_coord.x = u0; v[0].tex_coord.y = v0;
+    v[1].tex_coord.x = u1; v[1].tex_coord.y = v0;
+    v[2].tex_coord.x = u1; v[2].tex_coord.y = v1;
+    v[3].tex_coord.x = u0; v[3].tex_coord.y = v1;
+
+    v[0].color = v[1].color = v[2].color = v[3].color = c;
+}
+
+// An outline is four border quads (or one quad if the borders would
+// meet), so translucent corners are covered once.
+static int
+bm_sdl3__outline_quad_count(float w, float h, float t)
+{
+    return (w <= 2.0f * t || h <= 2.0f * t) ? 1 : 4;
+}
+
+static void
+bm_sdl3__outline_quads(SDL_Vertex *v, float x, float y, float w, float h,
+                       float t, SDL_FColor c)
+{
+    if (bm_sdl3__outline_quad_count(w, h, t) == 1) {
+        bm_sdl3__quad(v, x, y, w, h, 0.0f, 0.0f, 0.0f, 0.0f, c);
+        return;
+    }
+    bm_sdl3__quad(&v[0],  x,         y,         w, t,              0.0f, 0.0f, 0.0f, 0.0f, c);
+    bm_sdl3__quad(&v[4],  x,         y + h - t, w, t,              0.0f, 0.0f, 0.0f, 0.0f, c);
+    bm_sdl3__quad(&v[8],  x,         y + t,     t, h - 2.0f * t,   0.0f, 0.0f, 0.0f, 0.0f, c);
+    bm_sdl3__quad(&v[12], x + w - t, y + t,     t, h - 2.0f * t,   0.0f, 0.0f, 0.0f, 0.0f, c);
+}
+
+static int
+bm_sdl3__reserve_rows(BM_SDL3Renderer *r, int points)
+{
+    if (points <= r->rowCapacity) return 1;
+    int newCap = bm_sdl3__next_capacity(r->rowCapacity, points, 256);
+    BM_Point *rows = (BM_Point *)SDL_realloc(r->rows, (size_t)newCap * sizeof(BM_Point));
+    if (!rows) return 0;
+    r->rows        = rows;
+    r->rowCapacity = newCap;
+    return 1;
+}
+
+// Anti-aliased polyline as one strip draw: the solid core stops half
+// a pixel inside the stroke edge and a feather fades to zero alpha
+// half a pixel outside it. Strokes thinner than a pixel keep 1px
+// geometry and fade their alpha instead. Returns 0 on failure.
+static int
+bm_sdl3__polyline(BM_SDL3Renderer *r, BM_SDL3Batch *b,
+                  const BM_Point *p, int n, float thickness,
+                  float s, float offsetX, float offsetY, SDL_FColor fc)
+{
+    float widthPx = thickness * s;
+    if (widthPx < 1.0f) {
+        fc.a   *= widthPx;
+        widthPx = 1.0f;
+    }
+    float halfPx = widthPx * 0.5f;
+    if (!bm_sdl3__reserve_rows(r, 4 * n)) return 0;
+
+    int rows = bm_polyline_tessellate(p, n, halfPx / s, 4.0f, r->rows);
+    if (rows < 2) return 1;  // nothing to draw
+    SDL_Vertex *out = bm_sdl3__shape(b, BM_SDL3_DRAW_STRIP, rows * 4);
+    if (!out) return 0;
+
+    float inner = (halfPx - 0.5f) / halfPx;
+    float outer = (halfPx + 0.5f) / halfPx;
+    SDL_FColor clear = fc;
+    clear.a = 0.0f;
+
+    for (int k = 0; k < rows; ++k) {
+        const BM_Point *e = &r->rows[k * 2];
+        float lx = offsetX + e[0].x * s, ly = offsetY + e[0].y * s;
+        float rx = offsetX + e[1].x * s, ry = offsetY + e[1].y * s;
+        float cx = (lx + rx) * 0.5f, cy = (ly + ry) * 0.5f;
+        float dx = (lx - rx) * 0.5f, dy = (ly - ry) * 0.5f;
+
+        SDL_Vertex *v = &out[k * 4];
+        v[0].position.x = cx + dx * outer;  v[0].position.y = cy + dy * outer;
+        v[1].position.x = cx + dx * inner;  v[1].position.y = cy + dy * inner;
+        v[2].position.x = cx - dx * inner;  v[2].position.y = cy - dy * inner;
+        v[3].position.x = cx - dx * outer;  v[3].position.y = cy - dy * outer;
+        v[0].color = clear; v[1].color = fc; v[2].color = fc; v[3].color = clear;
+        for (int q = 0; q < 4; ++q) {
+            v[q].tex_coord.x = 0.0f;
+            v[q].tex_coord.y = 0.0f;
+        }
+    }
+    return 1;
+}
+
+#ifndef BM_CONFIG_NO_SHAPES
+// Returns the cached ring for an ellipse, tessellating on a miss.
+// Segment count keeps the chord error under half an output pixel.
+static const BM_SDL3EllipseTess *
+bm_sdl3__ellipse(BM_SDL3Renderer *r, float rx, float ry, int scale)
+{
+    Uint32 kx, ky;
+    SDL_memcpy(&kx, &rx, sizeof(kx));
+    SDL_memcpy(&ky, &ry, sizeof(ky));
+    Uint32 h = (kx * 0x9E3779B1u) ^ (ky * 0x85EBCA77u) ^ ((Uint32)scale * 0xC2B2AE3Du);
+    h ^= h >> 15;
+
+    BM_SDL3EllipseTess *e = &r->ellipses[h & (BM_SDL3_SHAPE_CACHE_SIZE - 1)];
+    if (e->scale == scale && e->rx == rx && e->ry == ry) return e;
+
+    float rpx = (rx > ry ? rx : ry) * (float)scale;
+    int   n   = 8;
+    if (rpx > 0.5f) {
+        n = (int)SDL_ceilf(SDL_PI_F / SDL_acosf(1.0f - 0.5f / rpx));
+    }
+    if (n < 8)   n = 8;
+    if (n > 512) n = 512;
+
+    if (!e->ring || e->segments < n) {
+        SDL_FPoint *ring = (SDL_FPoint *)SDL_realloc(e->ring, (size_t)n * sizeof(SDL_FPoint));
+        if (!ring) return NULL;
+        e->ring = ring;
+    }
+    float sx = rx * (float)scale;
+    float sy = ry * (float)scale;
+    for (int i = 0; i < n; ++i) {
+        float a = (float)i * (2.0f * SDL_PI_F / (float)n);
+        e->ring[i].x = SDL_cosf(a) * sx;
+        e->ring[i].y = SDL_sinf(a) * sy;
+    }
+    e->rx       = rx;
+    e->ry       = ry;
+    e->scale    = scale;
+    e->segments = n;
+    return e;
+}
+#endif
+
+static void
+bm_sdl3__free_tilemap_cache(BM_SDL3TilemapCache *tc)
+{
+    for (int i = 0; i < tc->cols * tc->rows; ++i) {
+        SDL_free(tc->chunks[i].quads);
+    }
+    SDL_free(tc->chunks);
+}
+
+#ifndef BM_CONFIG_NO_TILEMAPS
+static BM_SDL3TilemapCache *
+bm_sdl3__tilemap_cache(BM_SDL3Renderer *r, const BM_Tilemap *map)
+{
+    int cols = 0, rows = 0;
+    bm_tilemap_get_chunk_grid(map, &cols, &rows);
+
+    for (int i = 0; i < r->tilemapCount; ++i) {
+        BM_SDL3TilemapCache *tc = &r->tilemaps[i];
+        if (tc->map == map && tc->cols == cols && tc->rows == rows) return tc;
+    }
+
+    BM_SDL3TilemapCache *caches = (BM_SDL3TilemapCache *)SDL_realloc(
+        r->tilemaps, (size_t)(r->tilemapCount + 1) * sizeof(BM_SDL3TilemapCache));
+    if (!caches) return NULL;
+    r->tilemaps = caches;
+
+    BM_SDL3TilemapCache *tc = &caches[r->tilemapCount];
+    tc->chunks = (BM_SDL3Chunk *)SDL_calloc((size_t)cols * (size_t)rows,
+                                            sizeof(BM_SDL3Chunk));
+    if (!tc->chunks) return NULL;
+    tc->map  = map;
+    tc->cols = cols;
+    tc->rows = rows;
+    tc->lastUsed = r->renderSerial;
+    r->tilemapCount++;
+    return tc;
+}
+
+// Brings the visible chunks up to date and returns their quad total.
+static int
+bm_sdl3__update_chunks(BM_SDL3TilemapCache *tc,
+                       int cx0, int cy0, int cx1, int cy1)
+{
+    int total = 0;
+    for (int cy = cy0; cy < cy1; ++cy) {
+        for (int cx = cx0; cx < cx1; ++cx) {
+            BM_SDL3Chunk *ch = &tc->chunks[cy * tc->cols + cx];
+            uint32_t version = bm_tilemap_chunk_version(tc->map, cx, cy);
+            if (ch->version != version) {
+                if (!ch->quads) {
+                    ch->quads = (BM_TileQuad *)SDL_malloc(
+                        BM_TILEMAP_CHUNK * BM_TILEMAP_CHUNK * sizeof(BM_TileQuad));
+                    if (!ch->quads) continue;
+                }
+                ch->quadCount = bm_tilemap_build_chunk(tc->map, cx, cy, ch->quads);
+                ch->version   = version;
+            }
+            total += ch->quadCount;
+        }
+    }
+    return total;
+}
+#endif
+
+// Updates a batch's viewport, recomputing it on a size change only.
+// Writes nothing but `vp`: prepares of different batches may run
+// concurrently.
+static void
+bm_sdl3__viewport(const BM_SDL3Renderer *r, BM_SDL3Viewport *vp,
+                  int outputW, int outputH, float logicalW, float logicalH)
+{
+    BM_SDL3ScaleMode mode   = r->scaleMode;
+    int              canvas = mode != BM_SDL3_SCALE_INTEGER || r->logicalCanvas;
+    if (vp->scale && vp->outputW == outputW && vp->outputH == outputH &&
+        vp->logicalW == logicalW && vp->logicalH == logicalH &&
+        vp->mode == mode && (vp->canvasW != 0) == canvas) return;
+
+    float scaleX = (float)outputW / logicalW;
+    float scaleY = (float)outputH / logicalH;
+    float fit    = (scaleX < scaleY ? scaleX : scaleY);
+    float scale  = fit;
+    if (mode == BM_SDL3_SCALE_FILL) scale = (scaleX > scaleY ? scaleX : scaleY);
+
+    int intScale = (int)fit;
+    if (intScale < 1) intScale = 1;
+    if (mode == BM_SDL3_SCALE_INTEGER) scale = (float)intScale;
+    if (mode == BM_SDL3_SCALE_FIT || mode == BM_SDL3_SCALE_FILL) intScale = 1;
+
+    vp->outputW  = outputW;
+    vp->outputH  = outputH;
+    vp->logicalW = logicalW;
+    vp->logicalH = logicalH;
+    vp->mode     = mode;
+    vp->scale    = intScale;
+    vp->w        = logicalW * scale;
+    vp->h        = logicalH * scale;
+    vp->x        = ((float)outputW - vp->w) * 0.5f;
+    vp->y        = ((float)outputH - vp->h) * 0.5f;
+    vp->canvasW  = 0;
+    vp->canvasH  = 0;
+    if (canvas) {
+        vp->canvasW = (int)SDL_ceilf(logicalW);
+        vp->canvasH = (int)SDL_ceilf(logicalH);
+        if (vp->canvasW < 1) vp->canvasW = 1;
+        if (vp->canvasH < 1) vp->canvasH = 1;
+    }
+}
+
+// Logical -> output transform of one prepare.
+typedef struct {
+    float s;         // integer scale
+    int   intScale;
+    float offsetX;
+    float offsetY;
+    float outline;   // rect outline width in output pixels
+} BM_SDL3Xform;
+
+// Rect fills and outlines, sprites and plain lines use no renderer
+// cache, so any thread can build them. Returns 1 for such a command
+// along with its vertex and point counts (0 if it draws nothing).
+static int
+bm_sdl3__simple_counts(const BM_SDL3Renderer *r, const BM_Command *cmd,
+                       const BM_SDL3Xform *xf, int *verts, int *points)
+{
+    *verts  = 0;
+    *points = 0;
+    switch (cmd->type) {
+    case BM_CMD_RECT_FILL:
+        if (cmd->w > 0.0f && cmd->h > 0.0f) *verts = 4;
+        return 1;
+    case BM_CMD_RECT_OUTLINE:
+        if (cmd->w > 0.0f && cmd->h > 0.0f) {
+            *verts = 4 * bm_sdl3__outline_quad_count(cmd->w * xf->s, cmd->h * xf->s,
+                                                     xf->outline);
+        }
+        return 1;
+    case BM_CMD_SPRITE:
+        if (cmd->texture >= 0) *verts = 4;
+        return 1;
+    case BM_CMD_LINE:
+        if (r->smoothLines) return 0;
+        *points = 2;
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+// Writes a simple command's geometry to `v` (quads) or `p` (lines).
+static void
+bm_sdl3__simple_emit(const BM_CommandView *view, const BM_Command *cmd,
+                     const BM_SDL3Xform *xf, SDL_Vertex *v, SDL_FPoint *p)
+{
+    BM_Color   c  = bm_resolve_color(view, cmd->color);
+    SDL_FColor fc = { c.r, c.g, c.b, c.a };
+
+    // x, y, w, h (lines: x, y, x2, y2) in output pixels. The SSE2
+    // path does all four in one multiply-add with the same roundings
+    // as the scalar offset + value * scale.
+    float o[4];
+    int   line = cmd->type == BM_CMD_LINE;
+#ifdef BM_SDL3__SSE2
+    __m128 scale  = _mm_set1_ps(xf->s);
+    __m128 offset = _mm_setr_ps(xf->offsetX, xf->offsetY, 0.0f, 0.0f);
+    __m128 xywh   = _mm_loadu_ps(&cmd->x);
+    if (line) {
+        __m128 end = _mm_loadu_ps(&cmd->w);  // w, h, x2, y2
+        xywh   = _mm_shuffle_ps(xywh, end, _MM_SHUFFLE(3, 2, 1, 0));
+        offset = _mm_setr_ps(xf->offsetX, xf->offsetY, xf->offsetX, xf->offsetY);
+    }
+    _mm_storeu_ps(o, _mm_add_ps(_mm_mul_ps(xywh, scale), offset));
+#else
+    o[0] = xf->offsetX + cmd->x * xf->s;
+    o[1] = xf->offsetY + cmd->y * xf->s;
+    o[2] = line ? xf->offsetX + cmd->x2 * xf->s : cmd->w * xf->s;
+    o[3] = line ? xf->offsetY + cmd->y2 * xf->s : cmd->h * xf->s;
+#endif
+
+    switch (cmd->type) {
+    case BM_CMD_RECT_FILL:
+        bm_sdl3__quad(v, o[0], o[1], o[2], o[3], 0.0f, 0.0f, 0.0f, 0.0f, fc);
+        break;
+    case BM_CMD_RECT_OUTLINE:
+        bm_sdl3__outline_quads(v, o[0], o[1], o[2], o[3], xf->outline, fc);
+        break;
+    case BM_CMD_SPRITE:
+        bm_sdl3__quad(v, o[0], o[1], o[2], o[3], 0.0f, 0.0f, 1.0f, 1.0f, fc);
+        break;
+    default:  // BM_CMD_LINE
+        p[0].x = o[0];
+        p[0].y = o[1];
+        p[1].x = o[2];
+        p[1].y = o[3];
+        break;
+    }
+}
+
+static int
+bm_sdl3__prepare_simple(BM_SDL3Batch *b, const BM_CommandView *view,
+                        const BM_Command *cmd, const BM_SDL3Xform *xf,
+                        int verts, int points)
+{
+    if (verts) {
+        BM_TextureId texture = cmd->type == BM_CMD_SPRITE ? cmd->texture : -1;
+        SDL_Vertex  *v       = bm_sdl3__quads(b, texture, verts / 4);
+        if (!v) return 0;
+        bm_sdl3__simple_emit(view, cmd, xf, v, NULL);
+    } else if (points) {
+        SDL_FPoint *p = bm_sdl3__lines(b, bm_resolve_color(view, cmd->color), points);
+        if (!p) return 0;
+        bm_sdl3__simple_emit(view, cmd, xf, NULL, p);
+    }
+    return 1;
+}
+
+// Appends one command's geometry to the batch; 0 if out of memory.
+static int
+bm_sdl3__prepare_command(BM_SDL3Renderer      *r,
+                         BM_SDL3Batch         *b,
+                         const BM_CommandView *view,
+                         const BM_Command     *cmd,
+                         const BM_SDL3Xform   *xf)
+{
+    int verts, points;
+    if (bm_sdl3__simple_counts(r, cmd, xf, &verts, &points)) {
+        return bm_sdl3__prepare_simple(b, view, cmd, xf, verts, points);
+    }
+
+    float      s       = xf->s;
+    float      offsetX = xf->offsetX;
+    float      offsetY = xf->offsetY;
+    int        ok      = 1;
+    BM_Color   c       = bm_resolve_color(view, cmd->color);
+    SDL_FColor fc      = { c.r, c.g, c.b, c.a };
+
+    switch (cmd->type) {
+    case BM_CMD_LINE: {  // smooth; plain lines are simple
+        BM_Point seg[2] = { { cmd->x, cmd->y }, { cmd->x2, cmd->y2 } };
+        ok &= bm_sdl3__polyline(r, b, seg, 2, 1.0f, s, offsetX, offsetY, fc);
+    } break;
+
+#ifndef BM_CONFIG_NO_TEXT
+    case BM_CMD_TEXT: {
+        // All glyphs of one string -> one geometry submission.
+        int n = 0;
+        const BM_GlyphQuad *q = bm_text_get_quads(cmd, &n);
+        if (cmd->texture < 0 || !q || n == 0) break;
+        SDL_Vertex *v = bm_sdl3__quads(b, cmd->texture, n);
+        if (!v) { ok = 0; break; }
+
+        float ox = offsetX + cmd->x * s;
+        float oy = offsetY + cmd->y * s;
+        for (int g = 0; g < n; ++g) {
+            bm_sdl3__quad(&v[g * 4],
+                          ox + q[g].x * s, oy + q[g].y * s,
+                          q[g].w * s, q[g].h * s,
+                          q[g].u0, q[g].v0, q[g].u1, q[g].v1, fc);
+        }
+    } break;
+#endif
+
+#ifndef BM_CONFIG_NO_TILEMAPS
+    case BM_CMD_TILEMAP: {
+        // Cached chunk quads are only offset + scaled here; tile
+        // lookup and atlas math happen when a chunk changes.
+        if (cmd->texture < 0 || !cmd->object) break;
+        BM_SDL3TilemapCache *tc = bm_sdl3__tilemap_cache(r, (const BM_Tilemap *)cmd->object);
+        if (!tc) { ok = 0; break; }
+        tc->lastUsed = r->renderSerial;
+
+        int cx0, cy0, cx1, cy1;
+        bm_tilemap_get_visible(cmd, &cx0, &cy0, &cx1, &cy1);
+        int total = bm_sdl3__update_chunks(tc, cx0, cy0, cx1, cy1);
+        if (total == 0) break;
+        SDL_Vertex *v = bm_sdl3__quads(b, cmd->texture, total);
+        if (!v) { ok = 0; break; }
+
+        float ox = offsetX + cmd->x * s;
+        float oy = offsetY + cmd->y * s;
+        int   n  = 0;
+        for (int cy = cy0; cy < cy1; ++cy) {
+            for (int cx = cx0; cx < cx1; ++cx) {
+                const BM_SDL3Chunk *ch = &tc->chunks[cy * tc->cols + cx];
+                for (int k = 0; k < ch->quadCount; ++k, ++n) {
+                    const BM_TileQuad *q = &ch->quads[k];
+                    bm_sdl3__quad(&v[n * 4],
+                                  ox + q->x * s, oy + q->y * s,
+                                  q->w * s, q->h * s,
+                                  q->u0, q->v0, q->u1, q->v1, fc);
+                }
+            }
+        }
+    } break;
+#endif
+
+#ifndef BM_CONFIG_NO_SHAPES
+    case BM_CMD_ELLIPSE_FILL:
+    case BM_CMD_ELLIPSE_OUTLINE: {
+        if (cmd->w <= 0.0f || cmd->h <= 0.0f) break;
+        const BM_SDL3EllipseTess *e = bm_sdl3__ellipse(r, cmd->w, cmd->h, xf->intScale);
+        if (!e) { ok = 0; break; }
+        float cx = offsetX + cmd->x * s;
+        float cy = offsetY + cmd->y * s;
+        int   n  = e->segments;
+
+        if (cmd->type == BM_CMD_ELLIPSE_OUTLINE) {
+            SDL_FPoint *p = bm_sdl3__lines(b, c, n + 1);
+            if (!p) { ok = 0; break; }
+            for (int k = 0; k < n; ++k) {
+                p[k].x = cx + e->ring[k].x;
+                p[k].y = cy + e->ring[k].y;
+            }
+            p[n] = p[0];
+        } else {
+            SDL_Vertex *v = bm_sdl3__shape(b, BM_SDL3_DRAW_FAN, n);
+            if (!v) { ok = 0; break; }
+            for (int k = 0; k < n; ++k) {
+                v[k].position.x  = cx + e->ring[k].x;
+                v[k].position.y  = cy + e->ring[k].y;
+                v[k].tex_coord.x = 0.0f;
+                v[k].tex_coord.y = 0.0f;
+                v[k].color       = fc;
+            }
+        }
+    } break;
+
+    case BM_CMD_POLYGON_FILL:
+    case BM_CMD_POLYGON_OUTLINE: {
+        const BM_Point *p = bm_polygon_get_points(view, cmd);
+        int             n = (int)cmd->count;
+        if (!p || n < 2) break;
+
+        if (cmd->type == BM_CMD_POLYGON_OUTLINE) {
+            SDL_FPoint *o = bm_sdl3__lines(b, c, n + 1);
+            if (!o) { ok = 0; break; }
+            for (int k = 0; k < n; ++k) {
+                o[k].x = offsetX + p[k].x * s;
+                o[k].y = offsetY + p[k].y * s;
+            }
+            o[n] = o[0];
+        } else {
+            if (n < 3) break;
+            SDL_Vertex *v = bm_sdl3__shape(b, BM_SDL3_DRAW_FAN, n);
+            if (!v) { ok = 0; break; }
+            for (int k = 0; k < n; ++k) {
+                v[k].position.x  = offsetX + p[k].x * s;
+                v[k].position.y  = offsetY + p[k].y * s;
+                v[k].tex_coord.x = 0.0f;
+                v[k].tex_coord.y = 0.0f;
+                v[k].color       = fc;
+            }
+        }
+    } break;
+
+    case BM_CMD_POLYLINE: {
+        const BM_Point *p = bm_polygon_get_points(view, cmd);
+        if (!p) break;
+        ok &= bm_sdl3__polyline(r, b, p, (int)cmd->count, cmd->x2, s,
+                                offsetX, offsetY, fc);
+    } break;
+#endif
+
+#ifndef BM_CONFIG_NO_PARTICLES
+    case BM_CMD_PARTICLES: {
+        BM_ParticleView pv;
+        bm_particles_get_view(cmd, &pv);
+        if (pv.count == 0) break;
+
+        // Tint folded into the fade endpoints once per emitter.
+        SDL_FColor c0 = { pv.color_start.r * c.r, pv.color_start.g * c.g,
+                          pv.color_start.b * c.b, pv.color_start.a * c.a };
+        SDL_FColor c1 = { pv.color_end.r * c.r, pv.color_end.g * c.g,
+                          pv.color_end.b * c.b, pv.color_end.a * c.a };
+        float size = pv.size * s;
+        float half = pv.size * 0.5f;
+
+        for (int base = 0; base < pv.count; base += BM_SDL3_MAX_BATCH_QUADS) {
+            int n = pv.count - base;
+            if (n > BM_SDL3_MAX_BATCH_QUADS) n = BM_SDL3_MAX_BATCH_QUADS;
+            SDL_Vertex *v = bm_sdl3__quads(b, -1, n);
+            if (!v) { ok = 0; break; }
+            for (int k = 0; k < n; ++k) {
+                int   p = base + k;
+                float t = pv.t[p];
+                SDL_FColor pc = { c0.r + (c1.r - c0.r) * t, c0.g + (c1.g - c0.g) * t,
+                                  c0.b + (c1.b - c0.b) * t, c0.a + (c1.a - c0.a) * t };
+                bm_sdl3__quad(&v[k * 4],
+                              offsetX + (pv.x[p] - half) * s,
+                              offsetY + (pv.y[p] - half) * s,
+                              size, size, 0.0f, 0.0f, 0.0f, 0.0f, pc);
+            }
+        }
+    } break;
+#endif
+
+    default:
+        // Unknown command type, ignore.
+        break;
+    }
+    return ok;
+}
+
+// (Re)creates a target texture when its size changes. Targets are
+// copied opaque; the caller picks the scale mode per use.
+static SDL_Texture *
+bm_sdl3__target(SDL_Renderer *renderer, BM_SDL3Target *t, int w, int h)
+{
+    if (t->texture && t->w == w && t->h == h) return t->texture;
+    if (t->texture) SDL_DestroyTexture(t->texture);
+    t->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+                                   SDL_TEXTUREACCESS_TARGET, w, h);
+    t->w = 0;
+    t->h = 0;
+    if (!t->texture) return NULL;
+    SDL_SetTextureBlendMode(t->texture, SDL_BLENDMODE_NONE);
+    t->w = w;
+    t->h = h;
+    return t->texture;
+}
+
+static void
+bm_sdl3__clear(SDL_Renderer *renderer, BM_Color c)
+{
+    SDL_SetRenderDrawColor(
+        renderer,
+        (Uint8)(c.r * 255.0f),
+        (Uint8)(c.g * 255.0f),
+        (Uint8)(c.b * 255.0f),
+        (Uint8)(c.a * 255.0f)
+    );
+    SDL_RenderClear(renderer);
+}
+
+// ------------------------------------------------------------
+// Parallel prepare
+// ------------------------------------------------------------
+
+// Built-in pool for BM_SDL3_PrepareCommands when no parallelFor is
+// set: workers sleep on `wake` between jobs and claim task indices
+// under the lock; the calling thread claims tasks too.
+struct BM_SDL3Pool {
+    SDL_Mutex      *lock;
+    SDL_Condition  *wake;        // new job or quit
+    SDL_Condition  *idle;        // job finished
+    SDL_Thread    **threads;
+    int             threadCount;
+    int             requested;   // workers asked for
+    void          (*task)(void *data, int index);
+    void           *data;
+    int             count;
+    int             next;        // next unclaimed index
+    int             done;        // finished tasks
+    Uint32          generation;  // bumped per job
+    int             quit;
+};
+
+// Claims and runs tasks of the current job; lock held on entry/exit.
+static void
+bm_sdl3__pool_work(BM_SDL3Pool *pool)
+{
+    while (pool->next < pool->count) {
+        int    index = pool->next++;
+        void (*task)(void *, int) = pool->task;
+        void  *data  = pool->data;
+        SDL_UnlockMutex(pool->lock);
+        task(data, index);
+        SDL_LockMutex(pool->lock);
+        if (++pool->done == pool->count) SDL_SignalCondition(pool->idle);
+    }
+}
+
+static int
+bm_sdl3__pool_worker(void *arg)
+{
+    BM_SDL3Pool *pool = (BM_SDL3Pool *)arg;
+    Uint32       seen = 0;
+
+    SDL_LockMutex(pool->lock);
+    for (;;) {
+        while (!pool->quit && pool->generation == seen) {
+            SDL_WaitCondition(pool->wake, pool->lock);
+        }
+        if (pool->quit) break;
+        seen = pool->generation;
+        bm_sdl3__pool_work(pool);
+    }
+    SDL_UnlockMutex(pool->lock);
+    return 0;
+}
+
+static void
+bm_sdl3__pool_destroy(BM_SDL3Pool *pool)
+{
+    if (!pool) return;
+    if (pool->lock) {
+        SDL_LockMutex(pool->lock);
+        pool->quit = 1;
+        if (pool->wake) SDL_BroadcastCondition(pool->wake);
+        SDL_UnlockMutex(pool->lock);
+    }
+    for (int i = 0; i < pool->threadCount; ++i) {
+        SDL_WaitThread(pool->threads[i], NULL);
+    }
+    SDL_free(pool->threads);
+    if (pool->idle) SDL_DestroyCondition(pool->idle);
+    if (pool->wake) SDL_DestroyCondition(pool->wake);
+    if (pool->lock) SDL_DestroyMutex(pool->lock);
+    SDL_free(pool);
+}
+
+// A pool that failed to start some workers still runs jobs (with
+// fewer threads, or on the caller alone).
+static BM_SDL3Pool *
+bm_sdl3__pool_create(int workers)
 {
-    if (!renderer || !ctx) return;
+    BM_SDL3Pool *pool = (BM_SDL3Pool *)SDL_calloc(1, sizeof(BM_SDL3Pool));
+    if (!pool) return NULL;
+    pool->requested = workers;
+    pool->lock      = SDL_CreateMutex();
+    pool->wake      = SDL_CreateCondition();
+    pool->idle      = SDL_CreateCondition();
+    pool->threads   = (SDL_Thread **)SDL_calloc((size_t)workers, sizeof(SDL_Thread *));
+    if (!pool->lock || !pool->wake || !pool->idle || !pool->threads) {
+        bm_sdl3__pool_destroy(pool);
+        return NULL;
+    }
+    for (int i = 0; i < workers; ++i) {
+        pool->threads[i] = SDL_CreateThread(bm_sdl3__pool_worker, "bm_sdl3_prepare", pool);
+        if (!pool->threads[i]) break;
+        pool->threadCount++;
+    }
+    return pool;
+}
+
+static void
+bm_sdl3__parallel_for(BM_SDL3Renderer *r, void (*task)(void *, int),
+                      void *data, int count)
+{
+    if (r->parallelFor) {
+        r->parallelFor(task, data, count, r->parallelUser);
+        return;
+    }
+    if (r->pool && r->pool->requested != r->threads - 1) {
+        bm_sdl3__pool_destroy(r->pool);
+        r->pool = NULL;
+    }
+    if (!r->pool) r->pool = bm_sdl3__pool_create(r->threads - 1);
+
+    BM_SDL3Pool *pool = r->pool;
+    if (!pool) {
+        for (int i = 0; i < count; ++i) task(data, i);
+        return;
+    }
+    SDL_LockMutex(pool->lock);
+    pool->task  = task;
+    pool->data  = data;
+    pool->count = count;
+    pool->next  = 0;
+    pool->done  = 0;
+    pool->generation++;
+    SDL_BroadcastCondition(pool->wake);
+    bm_sdl3__pool_work(pool);
+    while (pool->done < pool->count) {
+        SDL_WaitCondition(pool->idle, pool->lock);
+    }
+    SDL_UnlockMutex(pool->lock);
+}
+
+typedef struct {
+    const BM_SDL3Renderer *r;
+    BM_SDL3Batch          *b;
+    const BM_CommandView  *view;
+    const BM_SDL3Xform    *xf;
+    BM_SDL3Range          *ranges;  // of this pass
+} BM_SDL3ParallelJob;
 
+// Pass 1: is the range simple, and how much geometry does it make?
+static void
+bm_sdl3__count_range(void *data, int index)
+{
+    BM_SDL3ParallelJob *job = (BM_SDL3ParallelJob *)data;
+    BM_SDL3Range       *rg  = &job->ranges[index];
+
+    rg->simple   = 1;
+    rg->vertices = 0;
+    rg->points   = 0;
+    rg->draws    = 0;
+    for (size_t i = rg->first; i < rg->first + rg->count; ++i) {
+        int verts, points;
+        if (!bm_sdl3__simple_counts(job->r, bm_command_at(job->view, i), job->xf,
+                                    &verts, &points)) {
+            rg->simple = 0;
+            return;
+        }
+        rg->vertices += verts;
+        rg->points   += points;
+        rg->draws    += (verts | points) != 0;
+    }
+}
+
+// Pass 2: writes a simple range into its batch slices, with draws
+// merged as bm_sdl3__quads would, relative to the range.
+static void
+bm_sdl3__build_range(void *data, int index)
+{
+    BM_SDL3ParallelJob *job    = (BM_SDL3ParallelJob *)data;
+    BM_SDL3Range       *rg     = &job->ranges[index];
+    BM_SDL3Draw        *d      = &job->r->rangeDraws[rg->drawBase];
+    int                 vertex = rg->vertexBase;
+    int                 point  = rg->pointBase;
+    int                 n      = 0;
+
+    for (size_t i = rg->first; i < rg->first + rg->count; ++i) {
+        const BM_Command *cmd = bm_command_at(job->view, i);
+        int verts, points;
+        bm_sdl3__simple_counts(job->r, cmd, job->xf, &verts, &points);
+        if (verts) {
+            BM_TextureId texture = cmd->type == BM_CMD_SPRITE ? cmd->texture : -1;
+            if (n && bm_sdl3__extends(&d[n - 1], texture, vertex, verts)) {
+                d[n - 1].count += verts;
+            } else {
+                d[n].kind    = BM_SDL3_DRAW_QUADS;
+                d[n].texture = texture;
+                d[n].first   = vertex;
+                d[n].count   = verts;
+                ++n;
+            }
+            bm_sdl3__simple_emit(job->view, cmd, job->xf, &job->b->vertices[vertex], NULL);
+            vertex += verts;
+        } else if (points) {
+            d[n].kind    = BM_SDL3_DRAW_LINES;
+            d[n].texture = -1;
+            d[n].color   = bm_resolve_color(job->view, cmd->color);
+            d[n].first   = point;
+            d[n].count   = points;
+            ++n;
+            bm_sdl3__simple_emit(job->view, cmd, job->xf, NULL, &job->b->points[point]);
+            point += points;
+        }
+    }
+    rg->drawCount = n;
+}
+
+static int
+bm_sdl3__prepare_range(BM_SDL3Renderer *r, BM_SDL3Batch *b,
+                       const BM_CommandView *view, const BM_SDL3Xform *xf,
+                       size_t first, size_t count)
+{
+    int ok = 1;
+    for (size_t i = first; i < first + count; ++i) {
+        ok &= bm_sdl3__prepare_command(r, b, view, bm_command_at(view, i), xf);
+    }
+    return ok;
+}
+
+// Appends range draw d of range g. Serial preparation grows the last
+// draw one command at a time (bm_sdl3__quads), so a quad draw that
+// does not fit whole is split at the same command it would have been:
+// its commands are walked again from the start of the range.
+static int
+bm_sdl3__append_range_draw(const BM_SDL3Renderer *r, BM_SDL3Batch *b,
+                           const BM_CommandView *view, const BM_SDL3Xform *xf,
+                           const BM_SDL3Range *g, const BM_SDL3Draw *d)
+{
+    BM_SDL3Draw *last = b->drawCount ? &b->draws[b->drawCount - 1] : NULL;
+    if (d->kind == BM_SDL3_DRAW_QUADS) {
+        if (bm_sdl3__extends(last, d->texture, d->first, d->count)) {
+            last->count += d->count;
+            return 1;
+        }
+        if (bm_sdl3__extends(last, d->texture, d->first, 0) ||
+            d->count / 4 > BM_SDL3_MAX_BATCH_QUADS) {
+            int end    = d->first + d->count;
+            int vertex = g->vertexBase;
+            for (size_t i = g->first; vertex < end; ++i) {
+                int verts, points;
+                bm_sdl3__simple_counts(r, bm_command_at(view, i), xf, &verts, &points);
+                if (vertex >= d->first && verts) {
+                    if (bm_sdl3__extends(last, d->texture, vertex, verts)) {
+                        last->count += verts;
+                    } else {
+                        if (!bm_sdl3__reserve_draws(b, b->drawCount + 1)) return 0;
+                        last        = &b->draws[b->drawCount++];
+                        *last       = *d;
+                        last->first = vertex;
+                        last->count = verts;
+                    }
+                }
+                vertex += verts;
+            }
+            return 1;
+        }
+    }
+    if (!bm_sdl3__reserve_draws(b, b->drawCount + 1)) return 0;
+    b->draws[b->drawCount++] = *d;
+    return 1;
+}
+
+// Splits the view into BM_SDL3_PARALLEL_CHUNK ranges. Runs of simple
+// ranges get prefix-summed slices of the batch and are built in
+// parallel, then their draws are appended in range order, merging
+// across range edges; other ranges are prepared serially in between.
+static int
+bm_sdl3__prepare_parallel(BM_SDL3Renderer *r, BM_SDL3Batch *b,
+                          const BM_CommandView *view, const BM_SDL3Xform *xf)
+{
+    int rangeCount = (int)((view->count + BM_SDL3_PARALLEL_CHUNK - 1) / BM_SDL3_PARALLEL_CHUNK);
+    if (rangeCount > r->rangeCapacity) {
+        BM_SDL3Range *ranges = (BM_SDL3Range *)SDL_realloc(
+            r->ranges, (size_t)rangeCount * sizeof(BM_SDL3Range));
+        if (!ranges) return bm_sdl3__prepare_range(r, b, view, xf, 0, view->count);
+        r->ranges        = ranges;
+        r->rangeCapacity = rangeCount;
+    }
+    for (int k = 0; k < rangeCount; ++k) {
+        size_t first = (size_t)k * BM_SDL3_PARALLEL_CHUNK;
+        size_t left  = view->count - first;
+        r->ranges[k].first = first;
+        r->ranges[k].count = left < BM_SDL3_PARALLEL_CHUNK ? left : BM_SDL3_PARALLEL_CHUNK;
+    }
+
+    BM_SDL3ParallelJob job = { r, b, view, xf, r->ranges };
+    bm_sdl3__parallel_for(r, bm_sdl3__count_range, &job, rangeCount);
+
+    int ok = 1;
+    for (int k = 0; k < rangeCount; ) {
+        BM_SDL3Range *rg = &r->ranges[k];
+        if (!rg->simple) {
+            ok &= bm_sdl3__prepare_range(r, b, view, xf, rg->first, rg->count);
+            ++k;
+            continue;
+        }
+
+        int end    = k;
+        int verts  = b->vertexCount;
+        int points = b->pointCount;
+        int draws  = 0;
+        for (; end < rangeCount && r->ranges[end].simple; ++end) {
+            BM_SDL3Range *g = &r->ranges[end];
+            g->vertexBase = verts;
+            g->pointBase  = points;
+            g->drawBase   = draws;
+            verts  += g->vertices;
+            points += g->points;
+            draws  += g->draws;
+        }
+        int quads = verts / 4 < BM_SDL3_MAX_BATCH_QUADS ? verts / 4 : BM_SDL3_MAX_BATCH_QUADS;
+
+        if (draws > r->rangeDrawCapacity) {
+            int          newCap = bm_sdl3__next_capacity(r->rangeDrawCapacity, draws, 1024);
+            BM_SDL3Draw *d      = (BM_SDL3Draw *)SDL_realloc(
+                r->rangeDraws, (size_t)newCap * sizeof(BM_SDL3Draw));
+            if (d) {
+                r->rangeDraws        = d;
+                r->rangeDrawCapacity = newCap;
+            }
+        }
+        if (draws > r->rangeDrawCapacity ||
+            !bm_sdl3__reserve_vertices(b, verts) ||
+            !bm_sdl3__reserve_points(b, points) ||
+            !bm_sdl3__reserve_draws(b, b->drawCount + draws) ||
+            !bm_sdl3__reserve_quads(b, quads)) {
+            // Out of memory: serially, keeping what still fits.
+            for (; k < end; ++k) {
+                ok &= bm_sdl3__prepare_range(r, b, view, xf,
+                                             r->ranges[k].first, r->ranges[k].count);
+            }
+            continue;
+        }
+
+        job.ranges = &r->ranges[k];
+        bm_sdl3__parallel_for(r, bm_sdl3__build_range, &job, end - k);
+
+        for (; k < end; ++k) {
+            const BM_SDL3Range *g = &r->ranges[k];
+            for (int i = 0; i < g->drawCount; ++i) {
+                ok &= bm_sdl3__append_range_draw(r, b, view, xf, g,
+                                                 &r->rangeDraws[g->drawBase + i]);
+            }
+        }
+        b->vertexCount = verts;
+        b->pointCount  = points;
+    }
+    return ok;
+}
+
+// ------------------------------------------------------------
+// Public API
+// ------------------------------------------------------------
+
+// Binds a BangerMan texture id to an SDL texture (NULL unbinds).
+// Textures stay owned by the caller.
+int
+BM_SDL3_SetTexture(BM_SDL3Renderer *r, BM_TextureId id, SDL_Texture *texture)
+{
+    if (!r || id < 0) return 0;
+    if (id >= r->textureCount) {
+        int newCount = r->textureCount ? r->textureCount : 16;
+        while (newCount <= id) newCount *= 2;
+
+        SDL_Texture **t = (SDL_Texture **)SDL_realloc(r->textures,
+                                                      (size_t)newCount * sizeof(SDL_Texture *));
+        if (!t) return 0;
+        for (int i = r->textureCount; i < newCount; ++i) t[i] = NULL;
+        r->textures     = t;
+        r->textureCount = newCount;
+    }
+    r->textures[id] = texture;
+    return 1;
+}
+
+// Converts a command view into `batch` for an output of
+// outputW x outputH pixels (query it on the render thread, e.g.
+// SDL_GetCurrentRenderOutputSize). Makes no SDL_Renderer calls.
+// Returns 0 if some commands were dropped for lack of memory.
+int
+BM_SDL3_PrepareCommands(BM_SDL3Renderer      *r,
+                        BM_SDL3Batch         *batch,
+                        const BM_CommandView *view,
+                        float                 logicalW,
+                        float                 logicalH,
+                        BM_Color              clear,
+                        int                   outputW,
+                        int                   outputH)
+{
+    if (!r || !batch || !view) return 0;
+    BM_SDL3Batch *b = batch;
+
+#ifdef BM_ENABLE_STATS
+    Uint64 startNS = SDL_GetTicksNS();
+#endif
+    b->vertexCount = 0;
+    b->pointCount  = 0;
+    b->drawCount   = 0;
+    b->complete    = 1;
+
+    BM_PROFILE_BEGIN("bm_sdl3_transform");
     // --------------------------------------------------------
-    // 1) Fetch command buffer + logical size
+    // 1) Integer scaling calc (pixel-art friendly), cached
     // --------------------------------------------------------
+    bm_sdl3__viewport(r, &b->viewport, outputW, outputH, logicalW, logicalH);
+    const BM_SDL3Viewport *vp = &b->viewport;
+    BM_PROFILE_END("bm_sdl3_transform");
+
+    b->clear = bm_resolve_color(view, clear);
+
+    // --------------------------------------------------------
+    // 2) Commands -> output-space geometry
+    // --------------------------------------------------------
+    BM_PROFILE_BEGIN("bm_sdl3_prepare");
+    BM_SDL3Xform xf;
+    xf.s        = 1.0f;  // canvas: logical pixels
+    xf.intScale = 1;
+    xf.offsetX  = 0.0f;
+    xf.offsetY  = 0.0f;
+    if (!vp->canvasW) {
+        xf.s        = (float)vp->scale;
+        xf.intScale = vp->scale;
+        xf.offsetX  = vp->x;
+        xf.offsetY  = vp->y;
+    }
+    xf.outline  = r->outlineThickness > 0.0f ? r->outlineThickness * xf.s : 1.0f;
+    int ok = 1;
+
+    if (r->threads > 1 && view->count >= BM_SDL3_PARALLEL_MIN) {
+        ok = bm_sdl3__prepare_parallel(r, b, view, &xf);
+    } else {
+        BM_CommandIter it = bm_command_iter(view);
+        for (const BM_Command *cmd; (cmd = bm_command_next(&it)) != NULL; ) {
+            ok &= bm_sdl3__prepare_command(r, b, view, cmd, &xf);
+        }
+    }
+    BM_PROFILE_END("bm_sdl3_prepare");
+
+    // Drop caches of tilemaps that are no longer drawn.
+    for (int i = 0; i < r->tilemapCount; ) {
+        if (r->renderSerial - r->tilemaps[i].lastUsed > BM_SDL3_TILEMAP_CACHE_FRAMES) {
+            bm_sdl3__free_tilemap_cache(&r->tilemaps[i]);
+            r->tilemaps[i] = r->tilemaps[--r->tilemapCount];
+        } else {
+            ++i;
+        }
+    }
+    r->renderSerial++;
+
+    b->complete = ok;
+#ifdef BM_ENABLE_STATS
+    b->prepareSeconds = (double)(SDL_GetTicksNS() - startNS) * 1e-9;
+#endif
+    return ok;
+}
+
+// BM_SDL3_PrepareCommands for a context's last recorded frame.
+int
+BM_SDL3_Prepare(BM_SDL3Renderer  *r,
+                BM_SDL3Batch     *batch,
+                const BM_Context *ctx,
+                int               outputW,
+                int               outputH)
+{
+    if (!r || !ctx) return 0;
+
     BM_CommandView view = {0};
     bm_get_commands(ctx, &view);
 
     float logicalW = 320.0f;
     float logicalH = 180.0f;
-    bm_get_logical_size(&logicalW, &logicalH);
+    bm_context_get_logical_size(ctx, &logicalW, &logicalH);
 
-    // --------------------------------------------------------
-    // 2) Integer scaling calc (pixel-art friendly)
-    // --------------------------------------------------------
-    float scaleX = (float)windowWidth  / logicalW;
-    float scaleY = (float)windowHeight / logicalH;
-    float scale  = (scaleX < scaleY ? scaleX : scaleY);
-    if (scale < 1.0f) scale = 1.0f;
-    int intScale = (int)scale;
-    if (intScale < 1) intScale = 1;
+    return BM_SDL3_PrepareCommands(r, batch, &view, logicalW, logicalH,
+                                   bm_context_get_clear_color(ctx),
+                                   outputW, outputH);
+}
 
-    float canvasW = logicalW * (float)intScale;
-    float canvasH = logicalH * (float)intScale;
+// Clears and draws a prepared batch. Render thread only; the batch
+// is only read, and must not be prepared into meanwhile.
+void
+BM_SDL3_Submit(BM_SDL3Renderer *r, const BM_SDL3Batch *batch)
+{
+    if (!r || !r->renderer || !batch) return;
+    SDL_Renderer       *renderer = r->renderer;
+    const BM_SDL3Batch *b        = batch;
 
-    float offsetX = ((float)windowWidth  - canvasW) * 0.5f;
-    float offsetY = ((float)windowHeight - canvasH) * 0.5f;
+#ifdef BM_ENABLE_STATS
+    Uint64 startNS      = SDL_GetTicksNS();
+    int    drawCalls    = 0;
+    int    stateChanges = 0;
+#endif
 
     // --------------------------------------------------------
-    // 3) Clear with BangerMan clear color
+    // 3) Clear with BangerMan clear color (scaled modes: into the
+    //    canvas; if it cannot be created the batch lands unscaled
+    //    at the output origin)
     // --------------------------------------------------------
-    BM_Color clear = bm_get_clear_color();
-    SDL_SetRenderDrawColor(
-        renderer,
-        (Uint8)(clear.r * 255.0f),
-        (Uint8)(clear.g * 255.0f),
-        (Uint8)(clear.b * 255.0f),
-        (Uint8)(clear.a * 255.0f)
-    );
-    SDL_RenderClear(renderer);
+    BM_PROFILE_BEGIN("bm_sdl3_clear");
+    const BM_SDL3Viewport *vp     = &b->viewport;
+    SDL_Texture           *output = NULL;
+    SDL_Texture           *canvas = NULL;
+    r->viewport = *vp;  // what is on screen from now on
+    if (vp->canvasW) {
+        canvas = bm_sdl3__target(renderer, &r->canvas, vp->canvasW, vp->canvasH);
+        if (canvas) {
+            output = SDL_GetRenderTarget(renderer);
+            SDL_SetRenderTarget(renderer, canvas);
+        }
+    }
+    bm_sdl3__clear(renderer, b->clear);
 
     SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    BM_PROFILE_END("bm_sdl3_clear");
 
     // --------------------------------------------------------
-    // 4) Replay commands
+    // 4) Draws (one zone per SDL call, so a trace shows how the
+    //    batch splits and what each flush costs)
     // --------------------------------------------------------
-    for (int i = 0; i < view.count; ++i) {
-        BM_Command *cmd = &view.commands[i];
-        BM_Color c = cmd->color;
-
-        SDL_SetRenderDrawColor(
-            renderer,
-            (Uint8)(c.r * 255.0f),
-            (Uint8)(c.g * 255.0f),
-            (Uint8)(c.b * 255.0f),
-            (Uint8)(c.a * 255.0f)
-        );
-
-        switch (cmd->type) {
-        case BM_CMD_RECT_FILL: {
-            SDL_FRect r;
-            r.x = offsetX + cmd->x * (float)intScale;
-            r.y = offsetY + cmd->y * (float)intScale;
-            r.w =        cmd->w * (float)intScale;
-            r.h =        cmd->h * (float)intScale;
-            SDL_RenderFillRect(renderer, &r);
-        } break;
-
-        case BM_CMD_RECT_OUTLINE: {
-            SDL_FRect r;
-            r.x = offsetX + cmd->x * (float)intScale;
-            r.y = offsetY + cmd->y * (float)intScale;
-            r.w =        cmd->w * (float)intScale;
-            r.h =        cmd->h * (float)intScale;
-            SDL_RenderRect(renderer, &r);
-        } break;
-
-        case BM_CMD_LINE: {
-            float x0 = offsetX + cmd->x  * (float)intScale;
-            float y0 = offsetY + cmd->y  * (float)intScale;
-            float x1 = offsetX + cmd->x2 * (float)intScale;
-            float y1 = offsetY + cmd->y2 * (float)intScale;
-            SDL_RenderLine(renderer, x0, y0, x1, y1);
-        } break;
-
-        case BM_CMD_SPRITE:
-            // TODO: sprite rendering will come later.
-            break;
+    BM_PROFILE_BEGIN("bm_sdl3_submit");
+    BM_PROFILE_COUNTER("bm_sdl3_draws", b->drawCount);
+    BM_PROFILE_COUNTER("bm_sdl3_vertices", b->vertexCount);
+    BM_PROFILE_COUNTER("bm_sdl3_points", b->pointCount);
+    int      haveColor = 0;
+    BM_Color lastColor = b->clear;
+
+    for (int i = 0; i < b->drawCount; ++i) {
+        const BM_SDL3Draw *d = &b->draws[i];
+
+        if (d->kind == BM_SDL3_DRAW_LINES) {
+            // Skip redundant draw color changes (geometry carries
+            // its color per vertex; only lines use the draw color).
+            BM_Color c = d->color;
+            if (!haveColor ||
+                c.r != lastColor.r || c.g != lastColor.g ||
+                c.b != lastColor.b || c.a != lastColor.a) {
+                SDL_SetRenderDrawColor(
+                    renderer,
+                    (Uint8)(c.r * 255.0f),
+                    (Uint8)(c.g * 255.0f),
+                    (Uint8)(c.b * 255.0f),
+                    (Uint8)(c.a * 255.0f)
+                );
+                lastColor = c;
+                haveColor = 1;
+#ifdef BM_ENABLE_STATS
+                ++stateChanges;
+#endif
+            }
+            const SDL_FPoint *p = &b->points[d->first];
+            BM_PROFILE_BEGIN("bm_sdl3_lines");
+            BM_PROFILE_COUNTER("bm_sdl3_batch_points", d->count);
+            if (d->count == 2) {
+                SDL_RenderLine(renderer, p[0].x, p[0].y, p[1].x, p[1].y);
+            } else {
+                SDL_RenderLines(renderer, p, d->count);
+            }
+            BM_PROFILE_END("bm_sdl3_lines");
+#ifdef BM_ENABLE_STATS
+            ++drawCalls;
+#endif
+            continue;
+        }
+
+        SDL_Texture *tex = NULL;
+        if (d->texture >= 0) {
+            tex = bm_sdl3__texture(r, d->texture);
+            if (!tex) continue;  // unbound: nothing to sample
+        }
 
+        const int *indices;
+        int        indexCount;
+        switch (d->kind) {
+        case BM_SDL3_DRAW_FAN:
+            indices    = b->fanIndices;
+            indexCount = (d->count - 2) * 3;
+            break;
+        case BM_SDL3_DRAW_STRIP:
+            indices    = b->stripIndices;
+            indexCount = (d->count / 4 - 1) * 18;
+            break;
         default:
-            // Unknown command type, ignore.
+            indices    = b->quadIndices;
+            indexCount = d->count / 4 * 6;
             break;
         }
+        BM_PROFILE_BEGIN("bm_sdl3_geometry");
+        BM_PROFILE_COUNTER("bm_sdl3_batch_vertices", d->count);
+        SDL_RenderGeometry(renderer, tex, &b->vertices[d->first], d->count,
+                           indices, indexCount);
+        BM_PROFILE_END("bm_sdl3_geometry");
+#ifdef BM_ENABLE_STATS
+        ++drawCalls;
+#endif
+    }
+    BM_PROFILE_END("bm_sdl3_submit");
+
+    // --------------------------------------------------------
+    // 5) Scaled modes: canvas -> output as one quad
+    // --------------------------------------------------------
+    if (canvas) {
+        BM_PROFILE_BEGIN("bm_sdl3_scale");
+        // SHARP at an exact integer fit is plain nearest.
+        SDL_Texture *src   = canvas;
+        int          sharp = vp->mode == BM_SDL3_SCALE_SHARP &&
+                             vp->w != vp->logicalW * (float)vp->scale;
+        SDL_SetTextureScaleMode(canvas, SDL_SCALEMODE_NEAREST);
+        if (sharp && vp->scale > 1) {
+            SDL_Texture *pre = bm_sdl3__target(renderer, &r->prescaled,
+                                               vp->canvasW * vp->scale,
+                                               vp->canvasH * vp->scale);
+            if (pre) {
+                SDL_SetRenderTarget(renderer, pre);
+                SDL_RenderTexture(renderer, canvas, NULL, NULL);
+                src = pre;
+#ifdef BM_ENABLE_STATS
+                ++drawCalls;
+#endif
+            }
+        }
+        if (sharp) SDL_SetTextureScaleMode(src, SDL_SCALEMODE_LINEAR);
+
+        // The canvas covers the logical size; a fractional logical
+        // size leaves a partial last texel column / row.
+        SDL_FRect from = { 0.0f, 0.0f, vp->logicalW, vp->logicalH };
+        SDL_FRect to   = { vp->x, vp->y, vp->w, vp->h };
+        if (src != canvas) {
+            from.w *= (float)vp->scale;
+            from.h *= (float)vp->scale;
+        }
+        SDL_SetRenderTarget(renderer, output);
+        bm_sdl3__clear(renderer, b->clear);  // letterbox bars
+        SDL_RenderTexture(renderer, src, &from, &to);
+        BM_PROFILE_END("bm_sdl3_scale");
+#ifdef BM_ENABLE_STATS
+        ++drawCalls;
+#endif
+    }
+
+#ifdef BM_ENABLE_STATS
+    r->stats.draw_calls     = drawCalls;
+    r->stats.state_changes  = stateChanges;
+    r->stats.replay_seconds = b->prepareSeconds +
+                              (double)(SDL_GetTicksNS() - startNS) * 1e-9;
+#endif
+}
+
+// Replays an explicit command view (e.g. a loaded capture frame)
+// without going through a BM_Context. Output size is the renderer's
+// current output (window or render target).
+void
+BM_SDL3_RenderCommands(BM_SDL3Renderer      *r,
+                       const BM_CommandView *view,
+                       float                 logicalW,
+                       float                 logicalH,
+                       BM_Color              clear)
+{
+    if (!r || !r->renderer || !view) return;
+
+    int outputW = 0;
+    int outputH = 0;
+    SDL_GetCurrentRenderOutputSize(r->renderer, &outputW, &outputH);
+
+    BM_SDL3_PrepareCommands(r, &r->batch, view, logicalW, logicalH, clear,
+                            outputW, outputH);
+    BM_SDL3_Submit(r, &r->batch);
+}
+
+void
+BM_SDL3_Render(BM_SDL3Renderer *r,
+               BM_Context      *ctx)
+{
+    if (!r || !ctx) return;
+
+    BM_CommandView view = {0};
+    bm_get_commands(ctx, &view);
+
+    float logicalW = 320.0f;
+    float logicalH = 180.0f;
+    bm_context_get_logical_size(ctx, &logicalW, &logicalH);
+
+    BM_SDL3_RenderCommands(r, &view, logicalW, logicalH,
+                           bm_context_get_clear_color(ctx));
+
+#ifdef BM_ENABLE_STATS
+    bm_report_backend_stats(ctx, &r->stats);
+#endif
+}
+
+// Frees a batch's buffers (the struct itself is caller-owned).
+void
+BM_SDL3_DestroyBatch(BM_SDL3Batch *batch)
+{
+    if (!batch) return;
+    SDL_free(batch->vertices);
+    SDL_free(batch->points);
+    SDL_free(batch->draws);
+    SDL_free(batch->quadIndices);
+    SDL_free(batch->fanIndices);
+    SDL_free(batch->stripIndices);
+    SDL_memset(batch, 0, sizeof(*batch));
+}
+
+// Frees backend-owned scratch memory and canvas textures (not the
+// SDL renderer or the bound textures); call before destroying the
+// SDL renderer.
+void
+BM_SDL3_Destroy(BM_SDL3Renderer *r)
+{
+    if (!r) return;
+    if (r->canvas.texture)    SDL_DestroyTexture(r->canvas.texture);
+    if (r->prescaled.texture) SDL_DestroyTexture(r->prescaled.texture);
+    SDL_memset(&r->canvas, 0, sizeof(r->canvas));
+    SDL_memset(&r->prescaled, 0, sizeof(r->prescaled));
+    for (int i = 0; i < r->tilemapCount; ++i) {
+        bm_sdl3__free_tilemap_cache(&r->tilemaps[i]);
+    }
+    SDL_free(r->tilemaps);
+    r->tilemaps     = NULL;
+    r->tilemapCount = 0;
+    for (int i = 0; i < BM_SDL3_SHAPE_CACHE_SIZE; ++i) {
+        SDL_free(r->ellipses[i].ring);
+        r->ellipses[i].ring     = NULL;
+        r->ellipses[i].scale    = 0;
+        r->ellipses[i].segments = 0;
     }
+    SDL_free(r->rows);
+    r->rows        = NULL;
+    r->rowCapacity = 0;
+    BM_SDL3_DestroyBatch(&r->batch);
+    bm_sdl3__pool_destroy(r->pool);
+    r->pool = NULL;
+    SDL_free(r->ranges);
+    r->ranges        = NULL;
+    r->rangeCapacity = 0;
+    SDL_free(r->rangeDraws);
+    r->rangeDraws        = NULL;
+    r->rangeDrawCapacity = 0;
+    SDL_free(r->textures);
+    r->textures     = NULL;
+    r->textureCount = 0;
 }
@@ -0,0 +1,328 @@
+// tools/replay-bench/main.c
+//
+// Headless replay benchmark: plays back a BangerMan capture
+// (see bm_capture_begin) through a backend and reports timings.
+//
+//   bm_replay <capture.bmcap> [--backend sdl3|cpu] [--iterations N]
+//             [--size WxH] [--format argb8888|rgb565|rgb444] [--dither]
+//
+// --format / --dither select the CPU backend's output format.
+//
+// Both backends run without a GPU or a display: the SDL3 path
+// uses SDL's software renderer on an offscreen surface.
+//
+// Compile with:
+//
+//   cc main.c -O2 -I../../ -lSDL3 -lm -o bm_replay
+//   cc main.c -O2 -I../../ -DBM_REPLAY_NO_SDL3 -lm -o bm_replay   // CPU only
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L  // clock_gettime
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#define BM_ENABLE_CAPTURE
+#define BANGERMAN_IMPLEMENTATION
+#include "../../bangerman.h"
+#include "../../renderers/CPU/bm_renderer_CPU.c"
+
+#ifndef BM_REPLAY_NO_SDL3
+#include <SDL3/SDL.h>
+#include "../../renderers/SDL3/bm_renderer_SDL3.c"
+#endif
+
+typedef enum {
+    REPLAY_BACKEND_CPU,
+    REPLAY_BACKEND_SDL3,
+} ReplayBackend;
+
+static double
+now_seconds(void)
+{
+#ifndef BM_REPLAY_NO_SDL3
+    return (double)SDL_GetTicksNS() * 1e-9;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+static int
+compare_doubles(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Output pixels covered by a frame's primitives at the given scale,
+// clipped to the canvas. Backend-independent so results compare.
+static double
+frame_pixels(const BM_CaptureFrame *frame, int scale)
+{
+    double lw = frame->logical_width;
+    double lh = frame->logical_height;
+    double s2 = (double)scale * (double)scale;
+    double px = lw * lh * s2;  // clear
+
+    BM_CommandIter it = bm_command_iter(&frame->view);
+    for (const BM_Command *cmd; (cmd = bm_command_next(&it)) != NULL; ) {
+        double x0 = cmd->x, y0 = cmd->y;
+        double x1 = cmd->x + cmd->w, y1 = cmd->y + cmd->h;
+        if (x0 < 0) x0 = 0;
+        if (y0 < 0) y0 = 0;
+        if (x1 > lw) x1 = lw;
+        if (y1 > lh) y1 = lh;
+        double w = x1 - x0, h = y1 - y0;
+
+        switch (cmd->type) {
+        case BM_CMD_RECT_FILL:
+        case BM_CMD_SPRITE:
+            if (w > 0 && h > 0) px += w * h * s2;
+            break;
+        case BM_CMD_RECT_OUTLINE:
+            if (w > 0 && h > 0) px += 2.0 * (w + h) * s2;
+            break;
+        case BM_CMD_LINE: {
+            double dx = cmd->x2 - cmd->x, dy = cmd->y2 - cmd->y;
+            double adx = dx < 0 ? -dx : dx, ady = dy < 0 ? -dy : dy;
+            px += (adx > ady ? adx : ady) * scale;
+        } break;
+        case BM_CMD_ELLIPSE_FILL:    // x, y, w, h = center + radii, unclipped
+            px += 3.14159265 * cmd->w * cmd->h * s2;
+            break;
+        case BM_CMD_ELLIPSE_OUTLINE:
+            px += 3.14159265 * (cmd->w + cmd->h) * scale;
+            break;
+        case BM_CMD_POLYLINE: {      // x2 = thickness
+            const BM_Point *p = bm_polygon_get_points(&frame->view, cmd);
+            if (!p) break;
+            double length = 0.0;
+            for (uint32_t k = 1; k < cmd->count; ++k) {
+                double ex = p[k].x - p[k - 1].x, ey = p[k].y - p[k - 1].y;
+                length += sqrt(ex * ex + ey * ey);
+            }
+            px += length * cmd->x2 * s2;
+        } break;
+        case BM_CMD_POLYGON_FILL:
+        case BM_CMD_POLYGON_OUTLINE: {
+            const BM_Point *p = bm_polygon_get_points(&frame->view, cmd);
+            if (!p) break;
+            double area = 0.0, perimeter = 0.0;
+            for (uint32_t k = 0, j = cmd->count - 1; k < cmd->count; j = k++) {
+                double ex = p[k].x - p[j].x, ey = p[k].y - p[j].y;
+                area      += (double)p[j].x * p[k].y - (double)p[k].x * p[j].y;
+                perimeter += sqrt(ex * ex + ey * ey);
+            }
+            if (cmd->type == BM_CMD_POLYGON_FILL) {
+                px += (area < 0 ? -area : area) * 0.5 * s2;
+            } else {
+                px += perimeter * scale;
+            }
+        } break;
+        default:
+            break;
+        }
+    }
+    return px;
+}
+
+static void
+usage(void)
+{
+    fprintf(stderr,
+            "usage: bm_replay <capture.bmcap> [--backend sdl3|cpu] "
+            "[--iterations N] [--size WxH] [--format argb8888|rgb565|rgb444] "
+            "[--dither]\n");
+}
+
+int main(int argc, char **argv)
+{
+    const char   *path       = NULL;
+    ReplayBackend backend    = REPLAY_BACKEND_CPU;
+    int           iterations = 10;
+    int           width      = 1280;
+    int           height     = 720;
+    BM_CPUFormat  format     = BM_CPU_FORMAT_ARGB8888;
+    int           dither     = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--backend") && i + 1 < argc) {
+            const char *name = argv[++i];
+            if (!strcmp(name, "cpu")) {
+                backend = REPLAY_BACKEND_CPU;
+            } else if (!strcmp(name, "sdl3")) {
+                backend = REPLAY_BACKEND_SDL3;
+            } else {
+                usage();
+                return 1;
+            }
+        } else if (!strcmp(argv[i], "--iterations") && i + 1 < argc) {
+            iterations = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--size") && i + 1 < argc) {
+            if (sscanf(argv[++i], "%dx%d", &width, &height) != 2) {
+                usage();
+                return 1;
+            }
+        } else if (!strcmp(argv[i], "--format") && i + 1 < argc) {
+            const char *name = argv[++i];
+            if (!strcmp(name, "argb8888")) {
+                format = BM_CPU_FORMAT_ARGB8888;
+            } else if (!strcmp(name, "rgb565")) {
+                format = BM_CPU_FORMAT_RGB565;
+            } else if (!strcmp(name, "rgb444")) {
+                format = BM_CPU_FORMAT_RGB444;
+            } else {
+                usage();
+                return 1;
+            }
+        } else if (!strcmp(argv[i], "--dither")) {
+            dither = 1;
+        } else if (argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (!path || iterations < 1 || width < 1 || height < 1) {
+        usage();
+        return 1;
+    }
+
+#ifdef BM_REPLAY_NO_SDL3
+    if (backend == REPLAY_BACKEND_SDL3) {
+        fprintf(stderr, "bm_replay: built without SDL3\n");
+        return 1;
+    }
+#endif
+
+    BM_CaptureFile *cap = bm_capture_open(path);
+    if (!cap) {
+        fprintf(stderr, "bm_replay: cannot open capture '%s'\n", path);
+        return 1;
+    }
+    int frameCount = bm_capture_frame_count(cap);
+    if (frameCount == 0) {
+        fprintf(stderr, "bm_replay: capture has no frames\n");
+        bm_capture_close(cap);
+        return 1;
+    }
+
+    // --------------------------------------------------------
+    // Backend setup
+    // --------------------------------------------------------
+    BM_CPURenderer cpu = {0};
+    uint32_t *cpuPixels = NULL;
+#ifndef BM_REPLAY_NO_SDL3
+    SDL_Surface    *surface  = NULL;
+    SDL_Renderer   *renderer = NULL;
+    BM_SDL3Renderer sdl      = {0};
+#endif
+
+    if (backend == REPLAY_BACKEND_CPU) {
+        cpuPixels = (uint32_t *)malloc((size_t)width * (size_t)height * sizeof(uint32_t));
+        if (!cpuPixels) {
+            bm_capture_close(cap);
+            return 1;
+        }
+        cpu.pixels = cpuPixels;  // large enough for every format
+        cpu.width  = width;
+        cpu.height = height;
+        cpu.format = format;
+        cpu.dither = dither;
+    }
+#ifndef BM_REPLAY_NO_SDL3
+    else {
+        surface  = SDL_CreateSurface(width, height, SDL_PIXELFORMAT_ARGB8888);
+        renderer = surface ? SDL_CreateSoftwareRenderer(surface) : NULL;
+        if (!renderer) {
+            fprintf(stderr, "bm_replay: SDL software renderer failed: %s\n",
+                    SDL_GetError());
+            if (surface) SDL_DestroySurface(surface);
+            bm_capture_close(cap);
+            return 1;
+        }
+        sdl.renderer = renderer;
+    }
+#endif
+
+    // --------------------------------------------------------
+    // Replay
+    // --------------------------------------------------------
+    size_t  sampleCount = (size_t)iterations * (size_t)frameCount;
+    double *samples     = (double *)malloc(sampleCount * sizeof(double));
+    double  totalCmds   = 0.0;
+    double  totalPixels = 0.0;
+    size_t  s           = 0;
+    if (!samples) {
+        bm_capture_close(cap);
+        return 1;
+    }
+
+    for (int it = 0; it < iterations; ++it) {
+        for (int f = 0; f < frameCount; ++f) {
+            BM_CaptureFrame frame;
+            bm_capture_get_frame(cap, f, &frame);
+
+            double t0 = now_seconds();
+            if (backend == REPLAY_BACKEND_CPU) {
+                BM_CPU_RenderCommands(&cpu, &frame.view,
+                                      frame.logical_width, frame.logical_height,
+                                      frame.clear_color);
+            }
+#ifndef BM_REPLAY_NO_SDL3
+            else {
+                BM_SDL3_RenderCommands(&sdl, &frame.view,
+                                       frame.logical_width, frame.logical_height,
+                                       frame.clear_color);
+                SDL_FlushRenderer(renderer);
+            }
+#endif
+            samples[s++] = now_seconds() - t0;
+
+            int sx = (int)((float)width  / frame.logical_width);
+            int sy = (int)((float)height / frame.logical_height);
+            int scale = sx < sy ? sx : sy;
+            if (scale < 1) scale = 1;
+            totalCmds   += frame.view.count;
+            totalPixels += frame_pixels(&frame, scale);
+        }
+    }
+
+    // --------------------------------------------------------
+    // Report
+    // --------------------------------------------------------
+    double total = 0.0;
+    for (size_t i = 0; i < sampleCount; ++i) total += samples[i];
+    qsort(samples, sampleCount, sizeof(double), compare_doubles);
+
+    size_t p99 = (size_t)((double)sampleCount * 0.99);
+    if (p99 >= sampleCount) p99 = sampleCount - 1;
+
+    printf("capture:        %s\n", path);
+    printf("backend:        %s\n", backend == REPLAY_BACKEND_CPU ? "cpu" : "sdl3");
+    printf("output size:    %dx%d\n", width, height);
+    printf("frames:         %d x %d iterations\n", frameCount, iterations);
+    printf("mean frame ms:  %.4f\n", total / (double)sampleCount * 1e3);
+    printf("p50 frame ms:   %.4f\n", samples[sampleCount / 2] * 1e3);
+    printf("p99 frame ms:   %.4f\n", samples[p99] * 1e3);
+    printf("commands/sec:   %.0f\n", total > 0.0 ? totalCmds / total : 0.0);
+    printf("pixels/sec:     %.0f\n", total > 0.0 ? totalPixels / total : 0.0);
+
+    free(samples);
+#ifndef BM_REPLAY_NO_SDL3
+    if (renderer) SDL_DestroyRenderer(renderer);
+    if (surface)  SDL_DestroySurface(surface);
+#endif
+    BM_CPU_Destroy(&cpu);
+    free(cpuPixels);
+    bm_capture_close(cap);
+    return 0;
+}